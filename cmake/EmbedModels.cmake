@@ -0,0 +1,42 @@
+# Compiles json models into a non-loader plugin target, in model index order:
+#   aidadsp_embed_models(<target> model1.json model2.json ...)
+# Included by the top level project and by tests, paths are relative to this file. Params are
+# folded unless AIDADSP_FOLD_PARAMS is set OFF, as in the plugin. The variant set of model engines
+# compiled in the target is pruned to the architectures of these models.
+
+set(AIDADSP_EMBED_MODELS_ROOT ${CMAKE_CURRENT_LIST_DIR}/..)
+
+function(aidadsp_embed_models target)
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+    set(EMBEDDED_MODELS_DIR ${CMAKE_CURRENT_BINARY_DIR}/${target}-embedded)
+    set(fold_params)
+    if(NOT DEFINED AIDADSP_FOLD_PARAMS OR AIDADSP_FOLD_PARAMS)
+        set(fold_params --fold-params)
+    endif()
+
+    # model paths may hold spaces, they go to the variant generator as a manifest
+    string(REPLACE ";" "\n" models_manifest "${ARGN}")
+    file(WRITE ${EMBEDDED_MODELS_DIR}/models.txt "${models_manifest}\n")
+
+    add_custom_command(
+        OUTPUT ${EMBEDDED_MODELS_DIR}/embedded_models.hpp
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${EMBEDDED_MODELS_DIR}
+        COMMAND ${Python3_EXECUTABLE} ${AIDADSP_EMBED_MODELS_ROOT}/variant/generate_embedded_models.py -o ${EMBEDDED_MODELS_DIR}/embedded_models.hpp ${fold_params} ${ARGN}
+        DEPENDS ${AIDADSP_EMBED_MODELS_ROOT}/variant/generate_embedded_models.py ${ARGN}
+        VERBATIM
+    )
+    add_custom_command(
+        OUTPUT ${EMBEDDED_MODELS_DIR}/model_variant.hpp ${EMBEDDED_MODELS_DIR}/model_families.hpp
+        COMMAND ${Python3_EXECUTABLE} ${AIDADSP_EMBED_MODELS_ROOT}/variant/generate_variant_hpp.py -o ${EMBEDDED_MODELS_DIR} --models ${EMBEDDED_MODELS_DIR}/models.txt ${fold_params}
+        DEPENDS ${AIDADSP_EMBED_MODELS_ROOT}/variant/generate_variant_hpp.py ${EMBEDDED_MODELS_DIR}/models.txt ${ARGN}
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE
+        ${AIDADSP_EMBED_MODELS_ROOT}/rt-neural-generic/src/embedded-models.cpp
+        ${EMBEDDED_MODELS_DIR}/embedded_models.hpp
+        ${EMBEDDED_MODELS_DIR}/model_variant.hpp
+        ${EMBEDDED_MODELS_DIR}/model_families.hpp
+    )
+    # ahead of the checked-in variant set
+    target_include_directories(${target} BEFORE PRIVATE ${EMBEDDED_MODELS_DIR})
+endfunction()
@@ -0,0 +1,32 @@
+# Applies patches/rtneural-*.patch to the RTNeural submodule before it is added:
+#   include(cmake/PatchRTNeural.cmake)
+# Included by the plugin and by tests, paths are relative to this file. A patch which reverts
+# cleanly is applied already, so configuring again or from another project leaves the tree as is.
+
+include_guard(GLOBAL)
+
+set(AIDADSP_RTNEURAL_DIR ${CMAKE_CURRENT_LIST_DIR}/../modules/RTNeural)
+file(GLOB AIDADSP_RTNEURAL_PATCHES ${CMAKE_CURRENT_LIST_DIR}/../patches/rtneural-*.patch)
+list(SORT AIDADSP_RTNEURAL_PATCHES)
+
+find_package(Git REQUIRED)
+foreach(patch ${AIDADSP_RTNEURAL_PATCHES})
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} apply --reverse --check ${patch}
+        WORKING_DIRECTORY ${AIDADSP_RTNEURAL_DIR}
+        RESULT_VARIABLE patch_applied
+        OUTPUT_QUIET ERROR_QUIET
+    )
+    if(NOT patch_applied EQUAL 0)
+        execute_process(
+            COMMAND ${GIT_EXECUTABLE} apply ${patch}
+            WORKING_DIRECTORY ${AIDADSP_RTNEURAL_DIR}
+            RESULT_VARIABLE patch_result
+        )
+        if(NOT patch_result EQUAL 0)
+            message(FATAL_ERROR "Unable to apply ${patch} to modules/RTNeural, is the submodule at the pinned commit?")
+        endif()
+        message("Applied ${patch} to modules/RTNeural")
+    endif()
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${patch})
+endforeach()
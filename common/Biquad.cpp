@@ -64,6 +64,10 @@ void Biquad::setBiquad(int type, double Fc, double Q, double peakGainDB) {
     setPeakGain(peakGainDB);
 }
 
+void Biquad::reset(void) {
+    z1 = z2 = 0.0;
+}
+
 void Biquad::calcBiquad(void) {
     double norm;
     double V = pow(10, fabs(peakGain) / 20.0);
@@ -39,6 +39,7 @@ public:
     void setFc(double Fc);
     void setPeakGain(double peakGainDB);
     void setBiquad(int type, double Fc, double Q, double peakGainDB);
+    void reset(void);
     float process(float in);
 
 protected:
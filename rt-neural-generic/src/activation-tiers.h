@@ -0,0 +1,21 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+/* Activation functions accuracy tiers, selected per build with AIDADSP_ACTIVATIONS, see activations.hpp */
+#define AIDADSP_ACTIVATIONS_EXACT 0 /* libm/xsimd tanh and exp */
+#define AIDADSP_ACTIVATIONS_PADE 1 /* rational [7/6] Pade approximant */
+#define AIDADSP_ACTIVATIONS_POLY 2 /* piecewise polynomial, no divisions */
+
+#ifndef AIDADSP_ACTIVATIONS
+#define AIDADSP_ACTIVATIONS AIDADSP_ACTIVATIONS_EXACT
+#endif
+
+/* Max abs error allowed against output_batch while testing a model, per tier */
+#define AIDADSP_ACTIVATIONS_EXACT_THR 1.0e-5
+#define AIDADSP_ACTIVATIONS_PADE_THR 1.0e-5
+#define AIDADSP_ACTIVATIONS_POLY_THR 5.0e-3
@@ -0,0 +1,130 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include <RTNeural/RTNeural.h>
+
+#include "activation-tiers.h"
+
+#if RTNEURAL_USE_EIGEN && (AIDADSP_ACTIVATIONS != AIDADSP_ACTIVATIONS_EXACT)
+#error Approximated activations are only available with RTNEURAL_XSIMD or RTNEURAL_STL backends
+#endif
+
+/**
+ * Everything below lives in the RTNeural namespace, which model-engine.cpp renames per backend:
+ * the maths providers derive from a different DefaultMathsProvider in each backend.
+ */
+namespace RTNeural {
+
+/**
+ * The helpers below are written once for plain floats (STL backend) and for
+ * xsimd batches, unqualified min/max/abs calls resolve to the xsimd overloads
+ * through ADL when T is a batch.
+ */
+namespace activations_detail {
+
+inline float select(bool cond, float a, float b) noexcept
+{
+    return cond ? a : b;
+}
+
+#if RTNEURAL_USE_XSIMD
+template <typename T, typename A>
+inline xsimd::batch<T, A> select(const xsimd::batch_bool<T, A>& cond, const xsimd::batch<T, A>& a, const xsimd::batch<T, A>& b) noexcept
+{
+    return xsimd::select(cond, a, b);
+}
+#endif
+
+template <typename T>
+inline T clamp(const T& x, float lo, float hi) noexcept
+{
+    using std::min;
+    using std::max;
+    return min(max(x, (T) lo), (T) hi);
+}
+
+} // namespace activations_detail
+
+/**
+ * Exact activations, this is what RTNeural does by default.
+ */
+struct ExactMathsProvider : DefaultMathsProvider
+{
+    /* Max abs error allowed against output_batch while testing a model */
+    static constexpr double test_threshold = AIDADSP_ACTIVATIONS_EXACT_THR;
+};
+
+/**
+ * tanh(x) ~ x * (135135 + 17325 x^2 + 378 x^4 + x^6) / (135135 + 62370 x^2 + 3150 x^4 + 28 x^6)
+ * Max abs error is ~1e-4 around |x| = 4.5, bundled models stay within 1e-5 from their output_batch.
+ */
+struct PadeMathsProvider : DefaultMathsProvider
+{
+    static constexpr double test_threshold = AIDADSP_ACTIVATIONS_PADE_THR;
+
+    template <typename T>
+    static T tanh(const T& x) noexcept
+    {
+        const T xc = activations_detail::clamp(x, -5.0f, 5.0f);
+        const T x2 = xc * xc;
+        const T num = xc * ((T) 135135.0f + x2 * ((T) 17325.0f + x2 * ((T) 378.0f + x2)));
+        const T den = (T) 135135.0f + x2 * ((T) 62370.0f + x2 * ((T) 3150.0f + x2 * (T) 28.0f));
+        return activations_detail::clamp(num / den, -1.0f, 1.0f);
+    }
+
+    template <typename T>
+    static T sigmoid(const T& x) noexcept
+    {
+        return (T) 0.5f + (T) 0.5f * tanh((T) 0.5f * x);
+    }
+};
+
+/**
+ * tanh(|x|) is split in [0, 1), [1, 3) and [3, 6) with a polynomial fitted on each segment,
+ * saturating to 1 above. All segments are evaluated and the right one is selected per lane,
+ * so there are no divisions at all: this is the cheapest tier on NEON targets without vdiv.
+ * Max abs error is ~2.3e-4, bundled models stay within 5e-3 from their output_batch.
+ */
+struct PolyMathsProvider : DefaultMathsProvider
+{
+    static constexpr double test_threshold = AIDADSP_ACTIVATIONS_POLY_THR;
+
+    template <typename T>
+    static T tanh(const T& x) noexcept
+    {
+        using std::abs;
+        const T ax = activations_detail::clamp(abs(x), 0.0f, 6.0f);
+        const T x2 = ax * ax;
+        const T pa = ax * ((T) 0.999726818f + x2 * ((T) -0.329087684f + x2 * ((T) 0.115742354f + x2 * (T) -0.0248210872f)));
+        T t = ax - (T) 1.0f;
+        const T pb = (T) 0.761755849f + t * ((T) 0.416741974f + t * ((T) -0.313455883f + t * ((T) 0.116334222f + t * (T) -0.0173282832f)));
+        t = ax - (T) 3.0f;
+        const T pc = (T) 0.995112367f + t * ((T) 0.00878234968f + t * ((T) -0.00634003009f + t * ((T) 0.00207419844f + t * (T) -0.000252477002f)));
+        const T y = activations_detail::clamp(activations_detail::select(ax < (T) 1.0f, pa, activations_detail::select(ax < (T) 3.0f, pb, pc)), 0.0f, 1.0f);
+        return activations_detail::select(x < (T) 0.0f, -y, y);
+    }
+
+    template <typename T>
+    static T sigmoid(const T& x) noexcept
+    {
+        return (T) 0.5f + (T) 0.5f * tanh((T) 0.5f * x);
+    }
+};
+
+#if AIDADSP_ACTIVATIONS == AIDADSP_ACTIVATIONS_PADE
+using ActivationMathsProvider = PadeMathsProvider;
+#elif AIDADSP_ACTIVATIONS == AIDADSP_ACTIVATIONS_POLY
+using ActivationMathsProvider = PolyMathsProvider;
+#else
+using ActivationMathsProvider = ExactMathsProvider;
+#endif
+
+} // namespace RTNeural
@@ -0,0 +1,365 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * Feed-forward dilated causal convolution models (WaveNet/TCN style). These are described in the
+ * json model file with RTNeural conv1d and dense layers:
+ *
+ *   { "type": "conv1d", "activation": "", "tanh" or "gated", "shape": [null, null, channels],
+ *     "kernel_size": [k], "dilation": [d], "residual": true or false,
+ *     "weights": [ kernel as k x in_size x out_size, bias ] }
+ *
+ * with the oldest tap first, as exported by Keras causal Conv1D. A gated layer has twice the
+ * channels in its weights, output is tanh of the first half times sigmoid of the second half. A
+ * residual layer adds its input to its output. Dense layers are 1x1 convolutions.
+ *
+ * There is no recurrence, so the whole layer stack runs on blocks of CONV_BLOCK samples, each
+ * layer keeping the last (k - 1) * d input frames in front of the block as history.
+ */
+
+#include "rt-neural-generic.h"
+
+/* Samples processed per pass through the layer stack */
+#define CONV_BLOCK 64
+
+namespace {
+
+enum ConvActivation {
+    kActivationLinear,
+    kActivationTanh,
+    kActivationGated
+};
+
+struct ConvLayer {
+    explicit ConvLayer(ModelArena& arena) : weights(arena), bias(arena), input(arena), warm_state(arena), acc(arena) {}
+
+    int in_size;
+    int out_size; /* Channels after activation */
+    int conv_size; /* Channels before activation, 2 * out_size for gated layers */
+    int kernel_size;
+    int dilation;
+    int history; /* Input frames kept in front of the block, (kernel_size - 1) * dilation */
+    ConvActivation activation;
+    bool residual;
+    EngineVector<float> weights; /* kernel_size x in_size x conv_size, oldest tap first */
+    EngineVector<float> bias; /* conv_size */
+    EngineVector<float> input; /* (history + CONV_BLOCK) x in_size frames, oldest first */
+    EngineVector<float> warm_state; /* Copy of input history, see saveState */
+    EngineVector<float> acc; /* conv_size scratch */
+};
+
+class alignas(CACHE_LINE_SIZE) ConvEngine : public ModelEngine
+{
+public:
+    explicit ConvEngine(ModelArena& arena) : layers(arena), output(arena) {}
+
+    void process(DynamicModel* model, float* out, uint32_t n_samples) override;
+    void saveState() override;
+    void restoreState() override;
+    void setInputKernel(const std::vector<std::vector<float>>& kernel) override;
+    void setOutputLayer(const std::vector<std::vector<float>>& weights, const std::vector<float>& bias) override;
+    void getMemoryRegions(MemoryRegions& regions) const override;
+    void serialize(ModelImage& image, const nlohmann::json& model_json) const override;
+
+    EngineVector<ConvLayer> layers;
+    EngineVector<float> output; /* CONV_BLOCK output of the last layer */
+    float output_gain; /* Applied after the last layer when it can't be folded into it */
+
+private:
+    void processLayer(ConvLayer& layer, float* y, uint32_t n_frames);
+};
+
+/**
+ * Runs n_frames of the current block through a layer, y is n_frames x out_size. The inner loop
+ * runs over output channels, contiguous in both weights and accumulator, so it gets vectorized.
+ */
+void ConvEngine::processLayer(ConvLayer& layer, float* y, uint32_t n_frames)
+{
+    const int in_size = layer.in_size;
+    const int out_size = layer.out_size;
+    const int conv_size = layer.conv_size;
+    const float* x = layer.input.data() + layer.history * in_size;
+    float* acc = layer.acc.data();
+
+    for (uint32_t t = 0; t < n_frames; t++) {
+        std::copy(layer.bias.begin(), layer.bias.end(), acc);
+        for (int j = 0; j < layer.kernel_size; j++) {
+            const float* xt = x + (static_cast<int>(t) - (layer.kernel_size - 1 - j) * layer.dilation) * in_size;
+            const float* w = layer.weights.data() + j * in_size * conv_size;
+            for (int c = 0; c < in_size; c++) {
+                const float xv = xt[c];
+                const float* wc = w + c * conv_size;
+                for (int o = 0; o < conv_size; o++) {
+                    acc[o] += wc[o] * xv;
+                }
+            }
+        }
+
+        float* yt = y + t * out_size;
+        switch (layer.activation) {
+            case kActivationLinear:
+                std::copy(acc, acc + out_size, yt);
+                break;
+            case kActivationTanh:
+                for (int o = 0; o < out_size; o++)
+                    yt[o] = tanhf(acc[o]);
+                break;
+            case kActivationGated:
+                for (int o = 0; o < out_size; o++)
+                    yt[o] = tanhf(acc[o]) / (1.0f + expf(-acc[out_size + o]));
+                break;
+        }
+        if (layer.residual) {
+            const float* xr = x + t * in_size;
+            for (int o = 0; o < out_size; o++)
+                yt[o] += xr[o];
+        }
+    }
+
+    /* Keep the last history frames in front of the next block */
+    std::copy(layer.input.begin() + n_frames * in_size, layer.input.begin() + (n_frames + layer.history) * in_size, layer.input.begin());
+}
+
+void ConvEngine::process(DynamicModel* model, float* out, uint32_t n_samples)
+{
+    const bool input_skip = model->input_skip;
+    const float skip_gain = model->skip_gain;
+    ConvLayer& first = layers.front();
+
+    for (uint32_t start = 0; start < n_samples; start += CONV_BLOCK) {
+        const uint32_t n_frames = std::min(n_samples - start, static_cast<uint32_t>(CONV_BLOCK));
+
+        float* x = first.input.data() + first.history * first.in_size;
+        for (uint32_t t = 0; t < n_frames; t++) {
+            x[t * first.in_size] = out[start + t];
+#if AIDADSP_CONDITIONED_MODELS
+            if (first.in_size > 1)
+                x[t * first.in_size + 1] = model->param1Coeff.next();
+            if (first.in_size > 2)
+                x[t * first.in_size + 2] = model->param2Coeff.next();
+#endif
+        }
+
+        for (size_t l = 0; l < layers.size(); l++) {
+            float* y = l + 1 < layers.size()
+                ? layers[l + 1].input.data() + layers[l + 1].history * layers[l + 1].in_size
+                : output.data();
+            processLayer(layers[l], y, n_frames);
+        }
+
+        for (uint32_t t = 0; t < n_frames; t++) {
+            const float y = output[t] * output_gain;
+            out[start + t] = input_skip ? y + out[start + t] * skip_gain : y;
+        }
+    }
+}
+
+/* Only the history in front of the block carries state */
+void ConvEngine::saveState()
+{
+    for (ConvLayer& layer : layers)
+        std::copy(layer.input.begin(), layer.input.begin() + layer.history * layer.in_size, layer.warm_state.begin());
+}
+
+void ConvEngine::restoreState()
+{
+    for (ConvLayer& layer : layers)
+        std::copy(layer.warm_state.begin(), layer.warm_state.end(), layer.input.begin());
+}
+
+void ConvEngine::getMemoryRegions(MemoryRegions& regions) const
+{
+    regions.push_back({ this, sizeof(*this) });
+    addMemoryRegion(regions, layers);
+    addMemoryRegion(regions, output);
+    for (const ConvLayer& layer : layers) {
+        addMemoryRegion(regions, layer.weights);
+        addMemoryRegion(regions, layer.bias);
+        addMemoryRegion(regions, layer.input);
+        addMemoryRegion(regions, layer.warm_state);
+        addMemoryRegion(regions, layer.acc);
+    }
+}
+
+/* Layers with their folded weights and history as saved, the rest is scratch */
+void ConvEngine::serialize(ModelImage& image, const nlohmann::json&) const
+{
+    image.put<uint64_t>(layers.size());
+    for (const ConvLayer& layer : layers) {
+        image.put(layer.in_size);
+        image.put(layer.out_size);
+        image.put(layer.conv_size);
+        image.put(layer.kernel_size);
+        image.put(layer.dilation);
+        image.put(layer.activation);
+        image.put(layer.residual);
+        image.putVector(layer.weights);
+        image.putVector(layer.bias);
+        image.putVector(layer.warm_state);
+    }
+    image.put(output_gain);
+}
+
+/* Gains are folded when the model is built, see createConvEngine */
+void ConvEngine::setInputKernel(const std::vector<std::vector<float>>&)
+{
+}
+
+void ConvEngine::setOutputLayer(const std::vector<std::vector<float>>&, const std::vector<float>&)
+{
+}
+
+/**********************************************************************************************************************************************************/
+
+ConvLayer parseLayer(const nlohmann::json& json_layer, int in_size, ModelArena& arena)
+{
+    ConvLayer layer(arena);
+    const std::string type = json_layer.at("type").get<std::string>();
+    const std::string activation = json_layer.contains("activation") ? json_layer.at("activation").get<std::string>() : "";
+    const nlohmann::json& json_weights = json_layer.at("weights");
+
+    layer.in_size = in_size;
+    layer.out_size = json_layer.at("shape").back().get<int>();
+    if (activation.empty() || activation == "linear")
+        layer.activation = kActivationLinear;
+    else if (activation == "tanh")
+        layer.activation = kActivationTanh;
+    else if (activation == "gated" && type == "conv1d")
+        layer.activation = kActivationGated;
+    else
+        throw std::invalid_argument("Activation " + activation + " not supported on " + type + " layers");
+    layer.conv_size = layer.activation == kActivationGated ? 2 * layer.out_size : layer.out_size;
+    layer.residual = json_layer.value("residual", false);
+    if (layer.residual && layer.in_size != layer.out_size)
+        throw std::invalid_argument("Residual layers need as many input as output channels");
+
+    /* Dense layers are convolutions with a single tap, kernel gets the same layout */
+    std::vector<std::vector<std::vector<float>>> kernel;
+    if (type == "conv1d") {
+        layer.kernel_size = json_layer.at("kernel_size").back().get<int>();
+        layer.dilation = json_layer.at("dilation").back().get<int>();
+        kernel = json_weights.at(0).get<std::vector<std::vector<std::vector<float>>>>();
+    }
+    else if (type == "dense") {
+        layer.kernel_size = 1;
+        layer.dilation = 1;
+        kernel = { json_weights.at(0).get<std::vector<std::vector<float>>>() };
+    }
+    else {
+        throw std::invalid_argument("Layer type " + type + " not supported in convolutional models");
+    }
+    if (layer.kernel_size < 1 || layer.dilation < 1)
+        throw std::invalid_argument("Kernel size and dilation must be at least 1");
+    layer.history = (layer.kernel_size - 1) * layer.dilation;
+
+    if (static_cast<int>(kernel.size()) != layer.kernel_size)
+        throw std::invalid_argument("Kernel size does not match weights");
+    layer.weights.reserve(layer.kernel_size * layer.in_size * layer.conv_size);
+    for (const auto& tap : kernel) {
+        if (static_cast<int>(tap.size()) != layer.in_size)
+            throw std::invalid_argument("Input size does not match weights");
+        for (const auto& row : tap) {
+            if (static_cast<int>(row.size()) != layer.conv_size)
+                throw std::invalid_argument("Output size does not match weights");
+            layer.weights.insert(layer.weights.end(), row.begin(), row.end());
+        }
+    }
+    const std::vector<float> bias = json_weights.at(1);
+    layer.bias.assign(bias.begin(), bias.end());
+    if (static_cast<int>(layer.bias.size()) != layer.conv_size)
+        throw std::invalid_argument("Output size does not match bias");
+
+    layer.input.assign((layer.history + CONV_BLOCK) * layer.in_size, 0.0f);
+    layer.warm_state.assign(layer.history * layer.in_size, 0.0f);
+    layer.acc.assign(layer.conv_size, 0.0f);
+
+    return layer;
+}
+
+/**
+ * Builds the layer stack and folds in_gain into the audio input weights of the first layer and
+ * out_gain into the last layer, unless it has an activation.
+ */
+ModelEngine* createConvEngine(const nlohmann::json& model_json, ModelArena& arena)
+{
+    EnginePtr<ConvEngine> engine(arena.construct<ConvEngine>(arena));
+
+    int in_size = model_json.at("in_shape").back().get<int>();
+    engine->layers.reserve(model_json.at("layers").size());
+    for (const nlohmann::json& json_layer : model_json.at("layers")) {
+        engine->layers.push_back(parseLayer(json_layer, in_size, arena));
+        in_size = engine->layers.back().out_size;
+    }
+    if (engine->layers.empty() || in_size != 1)
+        throw std::invalid_argument("Convolutional models need a single output channel");
+    engine->output.assign(CONV_BLOCK, 0.0f);
+
+    const bool has_input_gain = model_json.contains("in_gain") && model_json.at("in_gain").is_number();
+    const bool has_output_gain = model_json.contains("out_gain") && model_json.at("out_gain").is_number();
+    const float input_gain = has_input_gain ? DB_CO(model_json.at("in_gain").get<float>()) : 1.0f;
+    const float output_gain = has_output_gain ? DB_CO(model_json.at("out_gain").get<float>()) : 1.0f;
+
+    ConvLayer& first = engine->layers.front();
+    for (int j = 0; j < first.kernel_size; j++) {
+        float* w = first.weights.data() + j * first.in_size * first.conv_size;
+        for (int o = 0; o < first.conv_size; o++)
+            w[o] *= input_gain;
+    }
+
+    ConvLayer& last = engine->layers.back();
+    if (last.activation == kActivationLinear && !last.residual) {
+        for (float& w : last.weights)
+            w *= output_gain;
+        for (float& b : last.bias)
+            b *= output_gain;
+        engine->output_gain = 1.0f;
+    }
+    else {
+        engine->output_gain = output_gain;
+    }
+
+    return engine.release();
+}
+
+/* Built back as serialized, from its warm state, see ConvEngine::serialize */
+ModelEngine* restoreConvEngine(ModelImageReader& image, ModelArena& arena)
+{
+    EnginePtr<ConvEngine> engine(arena.construct<ConvEngine>(arena));
+
+    const uint64_t n_layers = image.get<uint64_t>();
+    engine->layers.reserve(n_layers);
+    for (uint64_t l = 0; l < n_layers; l++) {
+        ConvLayer layer(arena);
+        layer.in_size = image.get<int>();
+        layer.out_size = image.get<int>();
+        layer.conv_size = image.get<int>();
+        layer.kernel_size = image.get<int>();
+        layer.dilation = image.get<int>();
+        layer.history = (layer.kernel_size - 1) * layer.dilation;
+        layer.activation = image.get<ConvActivation>();
+        layer.residual = image.get<bool>();
+        image.getVector(layer.weights);
+        image.getVector(layer.bias);
+        image.getVector(layer.warm_state);
+        if (layer.kernel_size < 1 || layer.dilation < 1
+            || static_cast<int>(layer.weights.size()) != layer.kernel_size * layer.in_size * layer.conv_size
+            || static_cast<int>(layer.bias.size()) != layer.conv_size
+            || static_cast<int>(layer.warm_state.size()) != layer.history * layer.in_size)
+            throw std::runtime_error("Bad conv layer image");
+        layer.input.assign((layer.history + CONV_BLOCK) * layer.in_size, 0.0f);
+        std::copy(layer.warm_state.begin(), layer.warm_state.end(), layer.input.begin());
+        layer.acc.assign(layer.conv_size, 0.0f);
+        engine->layers.push_back(std::move(layer));
+    }
+    engine->output.assign(CONV_BLOCK, 0.0f);
+    engine->output_gain = image.get<float>();
+
+    return engine.release();
+}
+
+} // namespace
+
+const ModelBackend model_backend_conv = { AIDADSP_BACKEND_CONV, "conv", createConvEngine, restoreConvEngine, nullptr };
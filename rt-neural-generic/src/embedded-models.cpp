@@ -0,0 +1,72 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "embedded-models.h"
+
+#include <vector>
+
+#include <embedded_models.hpp>
+
+namespace {
+
+/* Nested arrays of the given shape, the innermost one straight from the floats */
+nlohmann::json embeddedArray(const float*& weights, const std::vector<size_t>& shape, size_t dim)
+{
+    if (dim + 1 == shape.size()) {
+        nlohmann::json array(std::vector<float>(weights, weights + shape[dim]));
+        weights += shape[dim];
+        return array;
+    }
+    nlohmann::json array = nlohmann::json::array();
+    for (size_t i = 0; i < shape[dim]; i++)
+        array.push_back(embeddedArray(weights, shape, dim + 1));
+    return array;
+}
+
+/* Replaces references left by the generator with the arrays they point to */
+void expandArrays(nlohmann::json& node, const EmbeddedModel& model)
+{
+    if (node.is_object() && node.contains("embedded_offset")) {
+        const size_t offset = node["embedded_offset"].get<size_t>();
+        const std::vector<size_t> shape = node["embedded_shape"].get<std::vector<size_t>>();
+        size_t size = 1;
+        for (const size_t dim : shape)
+            size *= dim;
+        if (shape.empty() || offset + size > model.n_weights)
+            throw std::out_of_range("Embedded array out of model weights");
+        const float* weights = model.weights + offset;
+        node = embeddedArray(weights, shape, 0);
+    }
+    else if (node.is_structured()) {
+        for (nlohmann::json& child : node)
+            expandArrays(child, model);
+    }
+}
+
+} // namespace
+
+int embeddedModelsCount()
+{
+    return EMBEDDED_MODELS_COUNT;
+}
+
+const char* embeddedModelName(int index)
+{
+    return embedded_models[index].name;
+}
+
+nlohmann::json embeddedModelJson(int index)
+{
+    const EmbeddedModel& model = embedded_models[index];
+    nlohmann::json model_json = nlohmann::json::parse(model.skeleton);
+    expandArrays(model_json, model);
+    return model_json;
+}
+
+const EmbeddedEngine* embeddedModelEngine(int index)
+{
+    return embedded_models[index].engine;
+}
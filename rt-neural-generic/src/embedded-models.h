@@ -0,0 +1,44 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * Models compiled into non-loader builds by variant/generate_embedded_models.py, indexed from 0 in
+ * the order they have been given to it. There is no file to read nor text weights to parse: the
+ * json is rebuilt from the float arrays in read-only data.
+ */
+int embeddedModelsCount();
+const char* embeddedModelName(int index);
+nlohmann::json embeddedModelJson(int index);
+
+/**
+ * Embedded recurrent model laid out at build time for the RTNeural model type named alias: its
+ * layer weights come first in its float array, in model type order, gains not folded. The plugin
+ * builds it from there with no json, see RtNeuralGeneric::createEmbeddedModel.
+ */
+struct EmbeddedEngine {
+    const char* alias; /* Model type, see model_variant.hpp */
+    const float* weights; /* Layer weights, see TypedEngine::serialize */
+    size_t n_weights;
+    const char* type; /* First layer type */
+    int hidden_size;
+    int input_size; /* As found in the model file, before params folding */
+    const float* param_weights; /* Params input weights, n_params rows of gates, with AIDADSP_FOLD_PARAMS */
+    int n_params;
+    int dense_input_size; /* Input size of the last dense layer */
+    bool input_skip;
+    float input_gain_db;
+    float output_gain_db;
+    float samplerate;
+};
+
+/* nullptr for models built from their json, e.g. convolutional ones */
+const EmbeddedEngine* embeddedModelEngine(int index);
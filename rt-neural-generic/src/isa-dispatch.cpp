@@ -0,0 +1,99 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * This is the binary the host loads when the plugin is built with AIDADSP_ISA_DISPATCH. The plugin
+ * itself is built once per ISA level as a separate shared object next to this one, and the best
+ * level the CPU supports is loaded the first time the host asks for a descriptor. Separate shared
+ * objects are needed since inline code compiled with different flags can't be mixed in one binary,
+ * the linker would keep just one copy of it.
+ */
+
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <string>
+
+#include <lv2/core/lv2.h>
+
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#ifndef PLUGIN_BINARY_NAME
+#define PLUGIN_BINARY_NAME "rt-neural-generic"
+#endif
+
+typedef const LV2_Descriptor* (*DescriptorFunction)(uint32_t index);
+
+/* ISA levels, best first, matching AIDADSP_ISA_LEVELS in CMakeLists.txt */
+#if defined(__x86_64__) || defined(__i386__)
+static const char* const isa_levels[] = { "avx512", "avx2", "sse2", nullptr };
+#elif defined(__arm__)
+static const char* const isa_levels[] = { "neon", "vfp", nullptr };
+#else
+#error ISA dispatch is not available for this architecture
+#endif
+
+static bool isaSupported(const char* isa)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (!strcmp(isa, "avx512"))
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")
+            && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq");
+    if (!strcmp(isa, "avx2"))
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(__arm__)
+    if (!strcmp(isa, "neon"))
+        return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+    return true; /* Baseline */
+}
+
+static DescriptorFunction loadBestIsa()
+{
+    /* Plugin binaries live next to this one in the bundle */
+    Dl_info info;
+    if (!dladdr((void*)&loadBestIsa, &info) || info.dli_fname == nullptr) {
+        std::cout << "Error! Unable to locate plugin bundle " << __func__ << " " << __LINE__ << std::endl;
+        return nullptr;
+    }
+    std::string bundle_path(info.dli_fname);
+    bundle_path.erase(bundle_path.find_last_of('/') + 1);
+
+    /* AIDADSP_ISA environment variable forces a level, for testing and benchmarks */
+    const char* forced_isa = getenv("AIDADSP_ISA");
+
+    for (int i = 0; isa_levels[i] != nullptr; i++) {
+        if (forced_isa != nullptr ? strcmp(forced_isa, isa_levels[i]) != 0 : !isaSupported(isa_levels[i]))
+            continue;
+
+        const std::string path = bundle_path + PLUGIN_BINARY_NAME "_" + isa_levels[i] + ".so";
+        // never closed, descriptors must stay valid until the host unloads us
+        void* lib = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (lib == nullptr) {
+            std::cout << "Error! Unable to load " << path << ": " << dlerror() << std::endl;
+            continue;
+        }
+        if (DescriptorFunction descriptor = (DescriptorFunction) dlsym(lib, "lv2_descriptor"))
+            return descriptor;
+        dlclose(lib);
+    }
+
+    std::cout << "Error! No usable plugin binary found in " << bundle_path << std::endl;
+    return nullptr;
+}
+
+LV2_SYMBOL_EXPORT
+const LV2_Descriptor* lv2_descriptor(uint32_t index)
+{
+    static const DescriptorFunction descriptor = loadBestIsa();
+    return descriptor != nullptr ? descriptor(index) : NULL;
+}
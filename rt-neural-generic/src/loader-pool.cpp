@@ -0,0 +1,58 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "loader-pool.h"
+
+#include <algorithm>
+
+LoaderPool& LoaderPool::instance()
+{
+    static LoaderPool pool;
+    return pool;
+}
+
+LoaderPool::~LoaderPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wakeup.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+void LoaderPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (threads.empty()) {
+            const unsigned cores = std::thread::hardware_concurrency();
+            const unsigned n_threads = std::clamp(cores > 1 ? cores - 1 : 1u, 1u, static_cast<unsigned>(LOADER_POOL_MAX_THREADS));
+            for (unsigned i = 0; i < n_threads; i++)
+                threads.emplace_back(&LoaderPool::threadFunction, this);
+        }
+        jobs.push_back(std::move(job));
+    }
+    wakeup.notify_one();
+}
+
+void LoaderPool::threadFunction()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        wakeup.wait(lock, [this] { return quit || !jobs.empty(); });
+        if (quit)
+            break;
+
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
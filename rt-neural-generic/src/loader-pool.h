@@ -0,0 +1,43 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Upper bound of loader threads, whatever the number of cores */
+#define LOADER_POOL_MAX_THREADS 4
+
+/**
+ * Threads shared by all plugin instances in the process to load models. Hosts usually run worker
+ * jobs of all instances one after the other, so a session with several instances would otherwise
+ * load their models one at a time. Threads are started on first use, one per core but the one
+ * left for audio, and jobs run in submission order. Nothing here is realtime safe.
+ */
+class LoaderPool
+{
+public:
+    static LoaderPool& instance();
+
+    void submit(std::function<void()> job);
+
+private:
+    LoaderPool() : quit(false) {}
+    ~LoaderPool();
+
+    void threadFunction();
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> threads;
+    bool quit;
+};
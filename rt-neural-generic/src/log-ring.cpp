@@ -0,0 +1,52 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "log-ring.h"
+
+namespace {
+
+struct RtLogFormat {
+    bool note; /* Note, or trace otherwise */
+    const char* format; /* Takes the message argument as int */
+};
+
+const RtLogFormat rt_log_formats[kRtLogMessagesCount] = {
+    { false, "patch:Set message with no property\n" },
+    { false, "patch:Set property is not a URID\n" },
+    { false, "patch:Set property body is not json\n" },
+    { false, "patch:Set message with no value\n" },
+    { false, "patch:Set value is not a Path\n" },
+    { false, "Queueing set message\n" },
+    { false, "Unknown object type %d\n" },
+    { false, "Unknown event type %d\n" },
+    { true, "Model pipeline missed a deadline, back to inline processing\n" },
+    { false, "Dropping superseded model\n" },
+    { false, "New model in use\n" },
+    { false, "loading = false\n" },
+};
+
+} // namespace
+
+void LogRing::flush(LV2_Log_Logger* logger)
+{
+    // cleared first, messages queued from now on ask for another flush
+    flush_pending.store(false, std::memory_order_release);
+
+    Record record;
+    while (ring.pop(record)) {
+        const RtLogFormat& format = rt_log_formats[record.message];
+        if (format.note)
+            lv2_log_note(logger, format.format, record.arg);
+        else
+            lv2_log_trace(logger, format.format, record.arg);
+    }
+
+    const uint32_t total_dropped = dropped.load(std::memory_order_relaxed);
+    if (total_dropped != dropped_reported) {
+        lv2_log_warning(logger, "%u realtime log messages dropped\n", total_dropped - dropped_reported);
+        dropped_reported = total_dropped;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <lv2/log/logger.h>
+
+#include "spsc-ring.h"
+
+/* Messages the audio thread can queue between two flushes, further ones are dropped */
+#define LOG_RING_SIZE 64
+
+/* Messages logged from the audio thread, their text is in log-ring.cpp */
+enum RtLogMessage : uint8_t {
+    kRtLogPatchNoProperty,
+    kRtLogPatchPropertyNotUrid,
+    kRtLogPatchPropertyNotJson,
+    kRtLogPatchNoValue,
+    kRtLogPatchValueNotPath,
+    kRtLogQueueingSet,
+    kRtLogUnknownObjectType,
+    kRtLogUnknownEventType,
+    kRtLogPipelineMissed,
+    kRtLogDroppingSuperseded,
+    kRtLogNewModel,
+    kRtLogLoadingDone,
+    kRtLogMessagesCount
+};
+
+/**
+ * Log of the audio thread. The host log may format and write right away, so the audio thread only
+ * queues a message id and an integer argument, and the worker formats and writes them. A full ring
+ * drops messages and counts them, the count is logged on next flush.
+ */
+class LogRing
+{
+public:
+    /* Realtime, audio thread only */
+    void log(RtLogMessage message, int32_t arg = 0)
+    {
+        if (ring.push({ message, arg }))
+            unflushed = true;
+        else
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /* Realtime, audio thread only: true once per batch of messages, the caller schedules a flush */
+    bool flushNeeded()
+    {
+        if (!unflushed || flush_pending.exchange(true, std::memory_order_acq_rel))
+            return false;
+        unflushed = false;
+        return true;
+    }
+
+    /* Non realtime, worker thread only */
+    void flush(LV2_Log_Logger* logger);
+
+private:
+    struct Record {
+        RtLogMessage message;
+        int32_t arg;
+    };
+
+    SpscRing<Record, LOG_RING_SIZE> ring;
+    std::atomic<uint32_t> dropped { 0 };
+    std::atomic<bool> flush_pending { false };
+    bool unflushed = false; /* Audio thread only */
+    uint32_t dropped_reported = 0; /* Worker thread only */
+};
@@ -0,0 +1,177 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/* Alignment of arena allocations, a cache line, which is what engines ask for at most */
+#define MODEL_ARENA_ALIGNMENT 64
+/* Smallest chunk mapped, engines made of many buffers fill a few of them */
+#define MODEL_ARENA_CHUNK_SIZE (64 * 1024)
+
+/**
+ * Storage of a model: its DynamicModel header first, then its engine, built in place right after
+ * it, then the buffers of that engine, see ArenaAllocator. Memory is mapped in page aligned chunks
+ * which belong to this model only, so they are locked once the model is built and unlocked when it
+ * is freed without touching the pages of any other model. Nothing is given back before the arena
+ * goes. Header only, engines built in variant modules allocate from it as well.
+ */
+class ModelArena
+{
+public:
+    /* reserved bytes are kept at the start of the first chunk for the header, see header */
+    explicit ModelArena(size_t reserved = 0)
+        : chunks(nullptr), last(nullptr), next(nullptr), end(nullptr), total(0), reserved(alignUp(reserved, MODEL_ARENA_ALIGNMENT)), locked(false) {}
+    ~ModelArena() { release(); }
+
+    ModelArena(const ModelArena&) = delete;
+    ModelArena& operator=(const ModelArena&) = delete;
+    ModelArena(ModelArena&& other) noexcept : ModelArena() { swap(other); }
+    ModelArena& operator=(ModelArena&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /* Maps a new chunk when the current one is full, throws std::bad_alloc if that fails */
+    void* allocate(size_t size, size_t alignment)
+    {
+        if (alignment > MODEL_ARENA_ALIGNMENT)
+            throw std::bad_alloc();
+        if (chunks == nullptr || alignUp(next, alignment) + size > end)
+            addChunk(size);
+        char* data = alignUp(next, alignment);
+        next = data + size;
+        return data;
+    }
+
+    template <typename T, typename... Args>
+    T* construct(Args&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /* Reserved bytes at the start of the first chunk, nullptr until something has been allocated */
+    void* header() const { return chunks != nullptr ? reinterpret_cast<char*>(chunks) + CHUNK_HEADER_SIZE : nullptr; }
+
+    /* Bytes mapped */
+    size_t size() const { return total; }
+
+    /* Calls f(data, size) on every chunk, page aligned */
+    template <typename F>
+    void forEachChunk(F f) const
+    {
+        for (Chunk* chunk = chunks; chunk != nullptr; chunk = chunk->next)
+            f(static_cast<void*>(chunk), chunk->size);
+    }
+
+    /**
+     * Locks every chunk mapped so far, once the model is built. Returns false with errno set when
+     * one of them could not be. Chunks are unlocked when the arena goes.
+     */
+    bool lock()
+    {
+        bool success = true;
+        for (Chunk* chunk = chunks; chunk != nullptr; chunk = chunk->next)
+            success &= mlock(chunk, chunk->size) == 0;
+        locked = true;
+        return success;
+    }
+
+private:
+    /* Start of every chunk, links them in mapping order */
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+    static constexpr size_t CHUNK_HEADER_SIZE = (sizeof(Chunk) + MODEL_ARENA_ALIGNMENT - 1) / MODEL_ARENA_ALIGNMENT * MODEL_ARENA_ALIGNMENT;
+
+    static size_t alignUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+    static char* alignUp(char* data, size_t alignment) { return reinterpret_cast<char*>(alignUp(reinterpret_cast<uintptr_t>(data), alignment)); }
+
+    /* Room for size bytes, and the header in the first chunk */
+    void addChunk(size_t size)
+    {
+        const size_t offset = CHUNK_HEADER_SIZE + (chunks == nullptr ? reserved : 0);
+        const size_t chunk_size = std::max(alignUp(offset + size, sysconf(_SC_PAGESIZE)), static_cast<size_t>(MODEL_ARENA_CHUNK_SIZE));
+        void* data = mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+            throw std::bad_alloc();
+
+        Chunk* chunk = static_cast<Chunk*>(data);
+        chunk->next = nullptr;
+        chunk->size = chunk_size;
+        if (chunks == nullptr)
+            chunks = chunk;
+        else
+            last->next = chunk;
+        last = chunk;
+        next = static_cast<char*>(data) + offset;
+        end = static_cast<char*>(data) + chunk_size;
+        total += chunk_size;
+    }
+
+    void release()
+    {
+        while (chunks != nullptr) {
+            Chunk* chunk = chunks;
+            chunks = chunk->next;
+            if (locked)
+                munlock(chunk, chunk->size);
+            munmap(chunk, chunk->size);
+        }
+    }
+
+    void swap(ModelArena& other) noexcept
+    {
+        std::swap(chunks, other.chunks);
+        std::swap(last, other.last);
+        std::swap(next, other.next);
+        std::swap(end, other.end);
+        std::swap(total, other.total);
+        std::swap(reserved, other.reserved);
+        std::swap(locked, other.locked);
+    }
+
+    Chunk* chunks;
+    Chunk* last;
+    char* next; /* Free space left in the last chunk */
+    char* end;
+    size_t total;
+    size_t reserved;
+    bool locked;
+};
+
+/**
+ * Allocator of engine buffers in the model arena, cache line aligned. Buffers are sized once while
+ * the engine is built, what they give back is only reclaimed with the arena.
+ */
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    ArenaAllocator(ModelArena& arena) noexcept : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), std::max(alignof(T), static_cast<size_t>(MODEL_ARENA_ALIGNMENT)))); }
+    void deallocate(T*, size_t) noexcept {}
+
+    ModelArena* arena;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
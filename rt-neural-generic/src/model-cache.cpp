@@ -0,0 +1,144 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "model-cache.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace {
+
+/* 64 bit FNV-1a, fast and good enough to tell model files apart */
+uint64_t hashBytes(uint64_t hash, const std::string& bytes)
+{
+    for (const unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string cacheDirectory()
+{
+    std::string dir;
+    if (const char* xdg_cache = getenv("XDG_CACHE_HOME"); xdg_cache != nullptr && xdg_cache[0] != '\0')
+        dir = xdg_cache;
+    else if (const char* home = getenv("HOME"); home != nullptr && home[0] != '\0')
+        dir = std::string(home) + "/.cache";
+    else
+        return "";
+
+    mkdir(dir.c_str(), 0755);
+    dir += "/" MODEL_CACHE_DIR;
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+        return "";
+    return dir;
+}
+
+} // namespace
+
+std::string modelCachePath(const std::string& content, const std::string& salt)
+{
+    const std::string dir = cacheDirectory();
+    if (dir.empty())
+        return "";
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = hashBytes(hash, std::to_string(MODEL_CACHE_VERSION));
+    hash = hashBytes(hash, salt);
+    hash = hashBytes(hash, content);
+
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.img", static_cast<unsigned long long>(hash));
+    return dir + name;
+}
+
+ModelCacheImage::~ModelCacheImage()
+{
+    if (data != nullptr)
+        munmap(data, size);
+}
+
+ModelImageReader ModelCacheImage::reader() const
+{
+    ModelImageReader image(data, size);
+    image.get<uint32_t>(); // magic
+    image.get<uint32_t>(); // version
+    return image;
+}
+
+bool readModelCache(const std::string& cache_path, ModelCacheImage& image)
+{
+    const int fd = open(cache_path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(2 * sizeof(uint32_t)))
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        unlink(cache_path.c_str());
+        return false;
+    }
+
+    const uint32_t* header = static_cast<const uint32_t*>(data);
+    if (header[0] != MODEL_CACHE_MAGIC || header[1] != MODEL_CACHE_VERSION) {
+        munmap(data, st.st_size);
+        unlink(cache_path.c_str());
+        return false;
+    }
+
+    image.data = data;
+    image.size = st.st_size;
+    return true;
+}
+
+void removeModelCache(const std::string& cache_path)
+{
+    unlink(cache_path.c_str());
+}
+
+bool writeModelCache(const std::string& cache_path, const ModelImage& model_image)
+{
+    ModelImage image;
+    image.put<uint32_t>(MODEL_CACHE_MAGIC);
+    image.put<uint32_t>(MODEL_CACHE_VERSION);
+    image.putBytes(model_image.bytes.data(), model_image.bytes.size());
+
+    std::string tmp_path = cache_path + ".XXXXXX";
+    const int fd = mkstemp(&tmp_path[0]);
+    if (fd < 0)
+        return false;
+
+    size_t written = 0;
+    while (written < image.bytes.size()) {
+        const ssize_t n = write(fd, image.bytes.data() + written, image.bytes.size() - written);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        written += n;
+    }
+    fchmod(fd, 0644);
+    const bool success = written == image.bytes.size() && close(fd) == 0 && rename(tmp_path.c_str(), cache_path.c_str()) == 0;
+    if (!success) {
+        if (written != image.bytes.size())
+            close(fd);
+        unlink(tmp_path.c_str());
+    }
+    return success;
+}
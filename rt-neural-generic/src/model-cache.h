@@ -0,0 +1,59 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include "model-image.h"
+
+/* Bump when the cache image layout or what the loader does with it changes */
+#define MODEL_CACHE_VERSION 2
+
+/* First bytes of an image, followed by MODEL_CACHE_VERSION */
+#define MODEL_CACHE_MAGIC 0x6164696bu
+
+/* Subdirectory of the user cache directory holding the images */
+#define MODEL_CACHE_DIR "aidadsp"
+
+/**
+ * Cache image of a json model file: the model as the loader built it, header, folded weights of
+ * its fastest engine and warm state, along with its cost, so that the next load neither parses
+ * json nor builds, warms up or benchmarks the model. Images are named by a hash of the file content
+ * and of the build, under $XDG_CACHE_HOME/aidadsp or ~/.cache/aidadsp.
+ * Returns an empty path when there is no cache directory.
+ */
+std::string modelCachePath(const std::string& content, const std::string& salt);
+
+/* Image mapped read only, unmapped when it goes */
+class ModelCacheImage
+{
+public:
+    ModelCacheImage() : data(nullptr), size(0) {}
+    ~ModelCacheImage();
+    ModelCacheImage(const ModelCacheImage&) = delete;
+    ModelCacheImage& operator=(const ModelCacheImage&) = delete;
+
+    /* What follows the magic and version */
+    ModelImageReader reader() const;
+
+private:
+    friend bool readModelCache(const std::string& cache_path, ModelCacheImage& image);
+
+    void* data;
+    size_t size;
+};
+
+/* Maps the image in, false on a miss or an image of another version, which gets removed */
+bool readModelCache(const std::string& cache_path, ModelCacheImage& image);
+
+/* Drops an image which could not be restored */
+void removeModelCache(const std::string& cache_path);
+
+/* Writes the image to a temporary file renamed over cache_path, concurrent loads may race safely */
+bool writeModelCache(const std::string& cache_path, const ModelImage& image);
@@ -0,0 +1,517 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * Model inference on the RTNeural backend selected with AIDADSP_BACKEND. This file is compiled once
+ * per backend listed in AIDADSP_BACKENDS, each time with RTNeural renamed into a namespace of its
+ * own, so that the same model types built on different backends can be linked in the same plugin.
+ * With AIDADSP_VARIANT_MODULES it is compiled once per backend and variant family instead, each
+ * into a module of its own, see variant-modules.cpp.
+ */
+
+#include "model-engine.h"
+
+#include <iterator>
+
+// RTNeural backend for this translation unit, whatever the RTNeural target has been configured with
+#undef RTNEURAL_USE_XSIMD
+#undef RTNEURAL_USE_EIGEN
+#if AIDADSP_BACKEND == AIDADSP_BACKEND_XSIMD
+    #define RTNEURAL_USE_XSIMD 1
+    #define RTNeural RTNeural_xsimd
+    #define BACKEND_NAME "xsimd"
+    #define BACKEND_SYMBOL model_backend_xsimd
+#elif AIDADSP_BACKEND == AIDADSP_BACKEND_EIGEN
+    #define RTNEURAL_USE_EIGEN 1
+    #define RTNeural RTNeural_eigen
+    #define BACKEND_NAME "eigen"
+    #define BACKEND_SYMBOL model_backend_eigen
+#elif AIDADSP_BACKEND == AIDADSP_BACKEND_STL
+    #define RTNeural RTNeural_stl
+    #define BACKEND_NAME "stl"
+    #define BACKEND_SYMBOL model_backend_stl
+#else
+    #error AIDADSP_BACKEND undefined or unknown
+#endif
+
+#include <model_variant.hpp>
+
+#include "rt-neural-generic.h"
+
+namespace {
+
+/**********************************************************************************************************************************************************/
+
+#if AIDADSP_FOLD_PARAMS
+/**
+ * Conditioned models run on the snapshot kernel, with params times their input weights folded
+ * into the recurrent layer input bias. Once params smoothers have settled the bias stays constant,
+ * while they are ramping it is refreshed every PARAM_FOLD_BLOCK samples.
+ * Returns how many samples can be processed with the bias currently in place.
+ */
+template <typename LayerType>
+uint32_t foldParams(DynamicModel* model, LayerType& layer, uint32_t n_samples)
+{
+    if (model->n_params == 0)
+        return n_samples;
+
+    LinearValueSmoother& param1Coeff = model->param1Coeff;
+    LinearValueSmoother& param2Coeff = model->param2Coeff;
+
+    if (param1Coeff.getCurrentValue() != param1Coeff.getTargetValue() ||
+        param2Coeff.getCurrentValue() != param2Coeff.getTargetValue()) {
+        n_samples = std::min(n_samples, static_cast<uint32_t>(PARAM_FOLD_BLOCK));
+        for (uint32_t i=0; i<n_samples; ++i) {
+            param1Coeff.next();
+            param2Coeff.next();
+        }
+    }
+
+    const float param1 = param1Coeff.getCurrentValue();
+    const float param2 = param2Coeff.getCurrentValue();
+    if (param1 != model->foldedParam1 || param2 != model->foldedParam2) {
+        model->foldedParam1 = param1;
+        model->foldedParam2 = param2;
+        std::vector<float>& bias = model->foldedBias[0];
+        for (size_t k=0; k<bias.size(); ++k) {
+            bias[k] = model->paramBias[k] + param1 * model->paramWeights[0][k] + param2 * model->paramWeights[1][k];
+        }
+        if constexpr (RTNeural::is_lstm_layer<LayerType>::value)
+            layer.setBVals(bias);
+        else
+            layer.setBVals(model->foldedBias);
+    }
+
+    return n_samples;
+}
+#endif
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Recurrent state of a model, what saveState keeps of it: the outputs of every recurrent layer,
+ * plus the cell state of LSTM layers. Dense and activation layers carry nothing from one sample
+ * to the next, and weights never change once the model is built, so they are left out.
+ */
+#if AIDADSP_BACKEND == AIDADSP_BACKEND_EIGEN
+// outs is a Map on the layer own storage
+template <typename LayerType>
+using StateVector = typename decltype(LayerType::outs)::PlainObject;
+#else
+template <typename LayerType>
+using StateVector = decltype(LayerType::outs);
+#endif
+
+template <typename Dst, typename Src>
+void copyState(Dst& dst, const Src& src)
+{
+    if constexpr (std::is_array_v<Dst>)
+        std::copy(std::begin(src), std::end(src), std::begin(dst));
+    else
+        dst = src;
+}
+
+template <typename LayerType, typename Enable = void>
+struct LayerState
+{
+    void save(const LayerType&) {}
+    void restore(LayerType&) const {}
+};
+
+template <typename LayerType>
+struct LayerState<LayerType, std::enable_if_t<RTNeural::is_gru_layer<LayerType>::value>>
+{
+    void save(const LayerType& layer) { copyState(outs, layer.outs); }
+    void restore(LayerType& layer) const { copyState(layer.outs, outs); }
+
+    StateVector<LayerType> outs;
+};
+
+template <typename LayerType>
+struct LayerState<LayerType, std::enable_if_t<RTNeural::is_lstm_layer<LayerType>::value>>
+{
+    void save(const LayerType& layer)
+    {
+        copyState(outs, layer.outs);
+        copyState(ct, layer.getCellState());
+    }
+    void restore(LayerType& layer) const
+    {
+        copyState(layer.outs, outs);
+        layer.setCellState(ct);
+    }
+
+    StateVector<LayerType> outs;
+    StateVector<LayerType> ct;
+};
+
+template <typename ModelType, typename Indices = std::make_index_sequence<RTNeural::model_layers_count<ModelType>::value>>
+struct ModelState;
+
+template <typename ModelType, size_t... Index>
+struct ModelState<ModelType, std::index_sequence<Index...>>
+{
+    void save(ModelType& model) { (std::get<Index>(layers).save(model.template get<Index>()), ...); }
+    void restore(ModelType& model) const { (std::get<Index>(layers).restore(model.template get<Index>()), ...); }
+
+    std::tuple<LayerState<std::decay_t<decltype(std::declval<ModelType&>().template get<Index>())>>...> layers;
+};
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Layer weights as a flat array, each weight tensor of the json model file row after row in file
+ * order, which is also the order of the model type layers with weights. They are set through the
+ * RTNeural setters, no json is involved. Activation layers have no weights.
+ */
+template <typename LayerType>
+constexpr size_t layerWeightsSize()
+{
+    constexpr size_t in_size = LayerType::in_size;
+    constexpr size_t out_size = LayerType::out_size;
+    if constexpr (RTNeural::is_lstm_layer<LayerType>::value)
+        return (in_size + out_size + 1) * 4 * out_size;
+    else if constexpr (RTNeural::is_gru_layer<LayerType>::value)
+        return (in_size + out_size + 2) * 3 * out_size;
+    else if constexpr (RTNeural::is_dense_layer<LayerType>::value)
+        return (in_size + 1) * out_size;
+    else
+        return 0;
+}
+
+inline std::vector<std::vector<float>> flatMatrix(const float*& weights, int rows, int cols)
+{
+    std::vector<std::vector<float>> matrix(rows);
+    for (auto& row : matrix) {
+        row.assign(weights, weights + cols);
+        weights += cols;
+    }
+    return matrix;
+}
+
+template <typename LayerType>
+void setLayerWeights(LayerType& layer, const float*& weights)
+{
+    constexpr int in_size = LayerType::in_size;
+    constexpr int out_size = LayerType::out_size;
+    if constexpr (RTNeural::is_lstm_layer<LayerType>::value)
+    {
+        layer.setWVals(flatMatrix(weights, in_size, 4 * out_size));
+        layer.setUVals(flatMatrix(weights, out_size, 4 * out_size));
+        layer.setBVals(flatMatrix(weights, 1, 4 * out_size)[0]);
+    }
+    else if constexpr (RTNeural::is_gru_layer<LayerType>::value)
+    {
+        layer.setWVals(flatMatrix(weights, in_size, 3 * out_size));
+        layer.setUVals(flatMatrix(weights, out_size, 3 * out_size));
+        layer.setBVals(flatMatrix(weights, 2, 3 * out_size));
+    }
+    else if constexpr (RTNeural::is_dense_layer<LayerType>::value)
+    {
+        // kernel is in_size x out_size in model files, RTNeural takes it transposed
+        const std::vector<std::vector<float>> kernel = flatMatrix(weights, in_size, out_size);
+        std::vector<std::vector<float>> dense_weights(out_size, std::vector<float>(in_size));
+        for (int i = 0; i < in_size; i++)
+            for (int o = 0; o < out_size; o++)
+                dense_weights[o][i] = kernel[i][o];
+        layer.setWeights(dense_weights);
+        layer.setBias(weights);
+        weights += out_size;
+    }
+}
+
+template <typename ModelType, size_t... Index>
+constexpr size_t modelWeightsSize(std::index_sequence<Index...>)
+{
+    return (layerWeightsSize<std::decay_t<decltype(std::declval<ModelType&>().template get<Index>())>>() + ... + 0);
+}
+
+template <typename ModelType, size_t... Index>
+void setModelWeights(ModelType& model, const float* weights, std::index_sequence<Index...>)
+{
+    (setLayerWeights(model.template get<Index>(), weights), ...);
+}
+
+/* Numbers of a json array, depth first */
+inline void flattenJson(const nlohmann::json& values, std::vector<float>& flat)
+{
+    if (values.is_array()) {
+        for (const nlohmann::json& value : values)
+            flattenJson(value, flat);
+    }
+    else {
+        flat.push_back(values.get<float>());
+    }
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Engine for one model architecture, allocated to its exact size: a ModelVariantType would take as
+ * much as the largest model. Model weights start on a cache line boundary, right after the model
+ * header in its arena.
+ */
+template <typename ModelType>
+class alignas(CACHE_LINE_SIZE) TypedEngine : public ModelEngine
+{
+public:
+    void process(DynamicModel* model, float* out, uint32_t n_samples) override;
+    void saveState() override;
+    void restoreState() override;
+    void setInputKernel(const std::vector<std::vector<float>>& kernel) override;
+    void setOutputLayer(const std::vector<std::vector<float>>& weights, const std::vector<float>& bias) override;
+    void getMemoryRegions(MemoryRegions& regions) const override { regions.push_back({ this, sizeof(*this) }); }
+    void serialize(ModelImage& image, const nlohmann::json& model_json) const override;
+    std::string getInfo() const override;
+
+    using Layers = std::make_index_sequence<RTNeural::model_layers_count<ModelType>::value>;
+
+    ModelType custom_model;
+    ModelState<ModelType> warm_state; /* See saveState */
+    const char* alias; /* Name of ModelType, see create_custom_model */
+};
+
+/**
+ * This function carries model calculations for snapshot models, models with one parameter and
+ * models with two parameters.
+ */
+template <typename ModelType>
+void TypedEngine<ModelType>::process(DynamicModel* model, float* out, uint32_t n_samples)
+{
+    const bool input_skip = model->input_skip;
+    const float skip_gain = model->skip_gain;
+#if AIDADSP_CONDITIONED_MODELS
+    LinearValueSmoother& param1Coeff = model->param1Coeff;
+    LinearValueSmoother& param2Coeff = model->param2Coeff;
+#endif
+
+    if constexpr (ModelType::input_size == 1)
+    {
+        uint32_t start = 0;
+        while (start < n_samples) {
+#if AIDADSP_FOLD_PARAMS
+            const uint32_t end = start + foldParams(model, custom_model.template get<0>(), n_samples - start);
+#else
+            const uint32_t end = n_samples;
+#endif
+            if (input_skip)
+            {
+                for (uint32_t i=start; i<end; ++i) {
+                    out[i] = custom_model.forward (out + i) + out[i] * skip_gain;
+                }
+            }
+            else
+            {
+                for (uint32_t i=start; i<end; ++i) {
+                    out[i] = custom_model.forward (out + i);
+                }
+            }
+            start = end;
+        }
+    }
+#if AIDADSP_CONDITIONED_MODELS
+    else if constexpr (ModelType::input_size == 2)
+    {
+        float inArray1 alignas(RTNEURAL_DEFAULT_ALIGNMENT)[2] = { 0.0, 0.0 };
+        if (input_skip)
+        {
+            for (uint32_t i=0; i<n_samples; ++i) {
+                inArray1[0] = out[i];
+                inArray1[1] = param1Coeff.next();
+                out[i] = custom_model.forward (inArray1) + out[i] * skip_gain;
+            }
+        }
+        else
+        {
+            for (uint32_t i=0; i<n_samples; ++i) {
+                inArray1[0] = out[i];
+                inArray1[1] = param1Coeff.next();
+                out[i] = custom_model.forward (inArray1);
+            }
+        }
+    }
+    else if constexpr (ModelType::input_size == 3)
+    {
+        float inArray2 alignas(RTNEURAL_DEFAULT_ALIGNMENT)[3] = { 0.0, 0.0, 0.0 };
+        if (input_skip)
+        {
+            for (uint32_t i=0; i<n_samples; ++i) {
+                inArray2[0] = out[i];
+                inArray2[1] = param1Coeff.next();
+                inArray2[2] = param2Coeff.next();
+                out[i] = custom_model.forward (inArray2) + out[i] * skip_gain;
+            }
+        }
+        else
+        {
+            for (uint32_t i=0; i<n_samples; ++i) {
+                inArray2[0] = out[i];
+                inArray2[1] = param1Coeff.next();
+                inArray2[2] = param2Coeff.next();
+                out[i] = custom_model.forward (inArray2);
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * Only the recurrent state is copied, layer by layer since stacked models carry state in every
+ * recurrent layer, a few hundred bytes against the whole model with its weights.
+ */
+template <typename ModelType>
+void TypedEngine<ModelType>::saveState()
+{
+    warm_state.save(custom_model);
+}
+
+template <typename ModelType>
+void TypedEngine<ModelType>::restoreState()
+{
+    warm_state.restore(custom_model);
+}
+
+/**
+ * Weights are set through RTNeural setters which transpose and pad them into the layout used by
+ * the backend.
+ */
+template <typename ModelType>
+void TypedEngine<ModelType>::setInputKernel(const std::vector<std::vector<float>>& kernel)
+{
+    custom_model.template get<0>().setWVals(kernel);
+}
+
+template <typename ModelType>
+void TypedEngine<ModelType>::setOutputLayer(const std::vector<std::vector<float>>& weights, const std::vector<float>& bias)
+{
+    constexpr size_t last = RTNeural::model_layers_count<ModelType>::value - 1;
+    custom_model.template get<last>().setWeights(weights);
+    custom_model.template get<last>().setBias(bias.data());
+}
+
+/**
+ * RTNeural layers don't give their weights back, they are taken from the model file. Warm state
+ * is stored as it is in memory, fixed size arrays of the backend types.
+ */
+template <typename ModelType>
+void TypedEngine<ModelType>::serialize(ModelImage& image, const nlohmann::json& model_json) const
+{
+    std::vector<float> weights;
+    for (const nlohmann::json& json_layer : model_json.at("layers"))
+        flattenJson(json_layer.at("weights"), weights);
+    if (weights.size() != modelWeightsSize<ModelType>(Layers{}))
+        throw std::invalid_argument("Model weights do not match " + std::string(alias));
+
+    image.putString(alias);
+    image.putVector(weights);
+    image.put<uint64_t>(sizeof(warm_state));
+    image.putBytes(&warm_state, sizeof(warm_state));
+}
+
+/* What the same model used to take, stored with a copy of it as warm state in ModelVariantType */
+template <typename ModelType>
+std::string TypedEngine<ModelType>::getInfo() const
+{
+    return std::to_string(sizeof(*this)) + " bytes, " + std::to_string(2 * sizeof(RTNeural::ModelVariantType)) + " as variant";
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * The model architecture is identified on its shape, see model_families.hpp, and the TypedEngine
+ * of that model type is built in place in the arena, no model is built to find out its type.
+ */
+ModelEngine* createEngine(const nlohmann::json& model_json, ModelArena& arena)
+{
+    return RTNeural::create_custom_model (model_json,
+        [&model_json, &arena] (auto model_type) -> ModelEngine*
+        {
+            using ModelType = typename decltype (model_type)::type;
+            if constexpr (! std::is_same_v<ModelType, RTNeural::NullModel>)
+            {
+                EnginePtr<TypedEngine<ModelType>> engine(arena.construct<TypedEngine<ModelType>>());
+                engine->alias = model_type.name;
+                engine->custom_model.parseJson (model_json, true);
+                engine->custom_model.reset();
+                return engine.release();
+            }
+            else
+            {
+                throw std::runtime_error (MODEL_VARIANT_UNSUPPORTED);
+            }
+        });
+}
+
+/* Model type named alias built from its flat weights, see TypedEngine::serialize */
+template <typename Create>
+ModelEngine* createEngineNamed(const std::string& alias, Create&& create)
+{
+    return RTNeural::create_custom_model_named (alias,
+        [&create] (auto model_type) -> ModelEngine*
+        {
+            using ModelType = typename decltype (model_type)::type;
+            if constexpr (! std::is_same_v<ModelType, RTNeural::NullModel>)
+            {
+                return create (model_type);
+            }
+            else
+            {
+                throw std::runtime_error (MODEL_VARIANT_UNSUPPORTED);
+            }
+        });
+}
+
+template <typename ModelType>
+EnginePtr<TypedEngine<ModelType>> buildEngine(const char* alias, const float* weights, size_t n_weights, ModelArena& arena)
+{
+    using Engine = TypedEngine<ModelType>;
+    if (n_weights != modelWeightsSize<ModelType>(typename Engine::Layers{}))
+        throw std::runtime_error ("Model weights do not match " + std::string(alias));
+
+    EnginePtr<Engine> engine(arena.construct<Engine>());
+    engine->alias = alias;
+    setModelWeights(engine->custom_model, weights, typename Engine::Layers{});
+    engine->custom_model.reset();
+    return engine;
+}
+
+/* Weights are read where they are, e.g. in read-only data for embedded models */
+ModelEngine* createNamedEngine(const char* alias, const float* weights, size_t n_weights, ModelArena& arena)
+{
+    return createEngineNamed (alias,
+        [weights, n_weights, &arena] (auto model_type) -> ModelEngine*
+        {
+            using ModelType = typename decltype (model_type)::type;
+            return buildEngine<ModelType>(model_type.name, weights, n_weights, arena).release();
+        });
+}
+
+/* Built back from the model type name, weights and warm state, see TypedEngine::serialize */
+ModelEngine* restoreEngine(ModelImageReader& image, ModelArena& arena)
+{
+    return createEngineNamed (image.getString(),
+        [&image, &arena] (auto model_type) -> ModelEngine*
+        {
+            using ModelType = typename decltype (model_type)::type;
+            std::vector<float> weights;
+            image.getVector(weights);
+            EnginePtr<TypedEngine<ModelType>> engine = buildEngine<ModelType>(model_type.name, weights.data(), weights.size(), arena);
+            if (image.get<uint64_t>() != sizeof(engine->warm_state))
+                throw std::runtime_error ("Bad model image for " + std::string(model_type.name));
+            image.getBytes(&engine->warm_state, sizeof(engine->warm_state));
+            engine->restoreState();
+            return engine.release();
+        });
+}
+
+} // namespace
+
+#ifdef MODEL_VARIANT_FAMILY
+/* Built as a variant family module, looked up by variant-modules.cpp */
+extern "C" __attribute__((visibility("default"))) const ModelBackend aidadsp_variant_module = { AIDADSP_BACKEND, BACKEND_NAME, createEngine, restoreEngine, createNamedEngine };
+#else
+const ModelBackend BACKEND_SYMBOL = { AIDADSP_BACKEND, BACKEND_NAME, createEngine, restoreEngine, createNamedEngine };
+#endif
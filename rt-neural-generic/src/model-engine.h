@@ -0,0 +1,121 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "model-arena.h"
+#include "model-image.h"
+
+/* RTNeural backends a model can run on, 0 lets the loader pick the fastest */
+#define AIDADSP_BACKEND_AUTO 0
+#define AIDADSP_BACKEND_XSIMD 1
+#define AIDADSP_BACKEND_EIGEN 2
+#define AIDADSP_BACKEND_STL 3
+/* Not an RTNeural backend, dilated convolution models get their own engine */
+#define AIDADSP_BACKEND_CONV 4
+/* Not an RTNeural backend either, block-sparse kernels for pruned recurrent models */
+#define AIDADSP_BACKEND_SPARSE 5
+/* Nor this one, low-rank factorized recurrent kernels */
+#define AIDADSP_BACKEND_LOWRANK 6
+
+struct DynamicModel;
+
+/* A block of memory owned by a model, see ModelEngine::getMemoryRegions */
+struct MemoryRegion {
+    const void* data;
+    size_t size;
+};
+typedef std::vector<MemoryRegion> MemoryRegions;
+
+/* Buffers of an engine, allocated in its model arena */
+template <typename T>
+using EngineVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename T, typename Allocator>
+inline void addMemoryRegion(MemoryRegions& regions, const std::vector<T, Allocator>& buffer)
+{
+    if (buffer.capacity() > 0)
+        regions.push_back({ buffer.data(), buffer.capacity() * sizeof(T) });
+}
+
+/**
+ * A model instance built by one of the RTNeural backends. Backends are compiled in their own
+ * translation unit (model-engine.cpp) and namespace, the plugin only sees this interface.
+ */
+class ModelEngine
+{
+public:
+    virtual ~ModelEngine() {}
+    /* Run the model in place, with params and skip settings from model */
+    virtual void process(DynamicModel* model, float* out, uint32_t n_samples) = 0;
+    /* Snapshot and restore of the model state, see DynamicModel::saveState */
+    virtual void saveState() = 0;
+    virtual void restoreState() = 0;
+    /* Replace the first layer input kernel, laid out as in the json file: in_size x gates */
+    virtual void setInputKernel(const std::vector<std::vector<float>>& kernel) = 0;
+    /* Replace the last dense layer weights, laid out as out_size x in_size, and bias */
+    virtual void setOutputLayer(const std::vector<std::vector<float>>& weights, const std::vector<float>& bias) = 0;
+    /* The engine and every buffer it owns, to be prefaulted and locked before going live */
+    virtual void getMemoryRegions(MemoryRegions& regions) const = 0;
+    /* Bytes taken by the engine and its buffers, for the memory report */
+    size_t getMemorySize() const
+    {
+        MemoryRegions regions;
+        getMemoryRegions(regions);
+        size_t size = 0;
+        for (const MemoryRegion& region : regions)
+            size += region.size;
+        return size;
+    }
+    /* Choices made while building the engine, worth a line in the log */
+    virtual std::string getInfo() const { return std::string(); }
+    /**
+     * Appends what the backend restore needs to build the engine again with no json: its weights, as
+     * folded so far, and its warm state. model_json is the model the engine has been built from, with
+     * gains folded, for engines which can't read their weights back.
+     */
+    virtual void serialize(ModelImage& image, const nlohmann::json& model_json) const = 0;
+};
+
+/* Engines are built in place in a model arena, they are destroyed in place and never deleted */
+struct EngineDeleter {
+    void operator()(ModelEngine* engine) const { engine->~ModelEngine(); }
+};
+template <typename Engine>
+using EnginePtr = std::unique_ptr<Engine, EngineDeleter>;
+
+struct ModelBackend {
+    int id;
+    const char* name;
+    /* Build and parse the model in arena, throws if its architecture is not supported */
+    ModelEngine* (*create)(const nlohmann::json& model_json, ModelArena& arena);
+    /* Build in arena an engine serialized by this backend, warm state in place, throws on a bad image */
+    ModelEngine* (*restore)(ModelImageReader& image, ModelArena& arena);
+    /* Build in arena the RTNeural model type named alias from its flat weights, see TypedEngine::serialize, nullptr for other engines */
+    ModelEngine* (*createNamed)(const char* alias, const float* weights, size_t n_weights, ModelArena& arena);
+};
+
+/* Defined by each backend compiled in, see AIDADSP_BACKENDS in CMakeLists.txt */
+extern const ModelBackend model_backend_xsimd;
+extern const ModelBackend model_backend_eigen;
+extern const ModelBackend model_backend_stl;
+/* Dilated convolution models, see conv-engine.cpp */
+extern const ModelBackend model_backend_conv;
+/* Pruned and low-rank recurrent models, see recurrent-engine.cpp */
+extern const ModelBackend model_backend_sparse;
+extern const ModelBackend model_backend_lowrank;
+
+/* Whether model_backend_sparse or model_backend_lowrank are worth benchmarking for this model */
+bool isSparseModel(const nlohmann::json& model_json);
+bool isLowRankModel(const nlohmann::json& model_json);
@@ -0,0 +1,101 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Binary image of a built model, see ModelEngine::serialize and model-cache.h. Values are stored
+ * as laid out in memory, an image is only read back by the build which wrote it. Header only,
+ * engines built in variant modules write and read images as well.
+ */
+class ModelImage
+{
+public:
+    template <typename T>
+    void put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain values are stored as they are");
+        putBytes(&value, sizeof(T));
+    }
+
+    void putBytes(const void* data, size_t size)
+    {
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    }
+
+    template <typename T, typename Allocator>
+    void putVector(const std::vector<T, Allocator>& values)
+    {
+        put<uint64_t>(values.size());
+        putBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void putString(const std::string& value)
+    {
+        put<uint64_t>(value.size());
+        putBytes(value.data(), value.size());
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+/* Reads an image back, throws std::runtime_error past its end */
+class ModelImageReader
+{
+public:
+    ModelImageReader(const void* data, size_t size) : next(static_cast<const uint8_t*>(data)), end(next + size) {}
+
+    template <typename T>
+    T get()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain values are stored as they are");
+        T value;
+        getBytes(&value, sizeof(T));
+        return value;
+    }
+
+    void getBytes(void* data, size_t size)
+    {
+        if (size > static_cast<size_t>(end - next))
+            throw std::runtime_error("Truncated model image");
+        if (size > 0)
+            memcpy(data, next, size);
+        next += size;
+    }
+
+    template <typename T, typename Allocator>
+    void getVector(std::vector<T, Allocator>& values)
+    {
+        const uint64_t size = get<uint64_t>();
+        if (size > static_cast<uint64_t>(end - next) / sizeof(T))
+            throw std::runtime_error("Truncated model image");
+        values.resize(size);
+        getBytes(values.data(), size * sizeof(T));
+    }
+
+    std::string getString()
+    {
+        const uint64_t size = get<uint64_t>();
+        if (size > static_cast<uint64_t>(end - next))
+            throw std::runtime_error("Truncated model image");
+        std::string value(reinterpret_cast<const char*>(next), size);
+        next += size;
+        return value;
+    }
+
+private:
+    const uint8_t* next;
+    const uint8_t* end;
+};
@@ -0,0 +1,544 @@
+#pragma once
+#include <initializer_list>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#define MODEL_FAMILY_GRU_SMALL 0
+#define MODEL_FAMILY_GRU_LARGE 1
+#define MODEL_FAMILY_LSTM_SMALL 2
+#define MODEL_FAMILY_LSTM_LARGE 3
+#define MODEL_FAMILIES_COUNT 4
+static constexpr const char* model_family_names[] = { "gru_small", "gru_large", "lstm_small", "lstm_large" };
+#define MODEL_VARIANT_UNSUPPORTED "Unable to identify a known model architecture!"
+
+struct LayerShape { const char* type; int size; const char* activation; };
+inline bool is_layers_shape (const nlohmann::json& json_layers, std::initializer_list<LayerShape> layer_shapes) {
+    if (json_layers.size() != layer_shapes.size())
+        return false;
+    size_t i = 0;
+    for (const auto& layer_shape : layer_shapes) {
+        const auto& json_layer = json_layers.at (i++);
+        const auto layer_type = json_layer.at ("type").get<std::string>();
+        const auto size = json_layer.at ("shape").back().get<int>();
+        auto activation = json_layer.contains ("activation") ? json_layer.at ("activation").get<std::string>() : std::string();
+        if (layer_type != "dense" || activation == "linear")
+            activation.clear();
+        if (layer_type != layer_shape.type || size != layer_shape.size || activation != layer_shape.activation)
+            return false;
+    }
+    return true;
+}
+
+inline bool is_model_type_ModelType_GRU_8_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 8, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_12_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 12, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_16_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 16, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_20_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 20, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_24_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 24, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_32_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 32, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_40_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 40, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_64_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 64, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_80_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 80, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_8_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 8, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_12_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 12, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_16_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 16, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_20_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 20, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_24_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 24, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_32_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 32, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_40_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 40, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_64_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 64, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_80_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 80, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_2x8_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 8, "" }, { "gru", 8, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_2x12_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 12, "" }, { "gru", 12, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_2x16_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 16, "" }, { "gru", 16, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_2x20_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 20, "" }, { "gru", 20, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_2x24_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 24, "" }, { "gru", 24, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_2x32_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 32, "" }, { "gru", 32, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_2x8_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 8, "" }, { "lstm", 8, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_2x12_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 12, "" }, { "lstm", 12, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_2x16_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 16, "" }, { "lstm", 16, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_2x20_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 20, "" }, { "lstm", 20, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_2x24_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 24, "" }, { "lstm", 24, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_2x32_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 32, "" }, { "lstm", 32, "" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_16_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 16, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_16_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 16, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_24_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 24, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_24_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 24, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_32_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 32, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_32_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 32, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_40_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 40, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_GRU_40_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "gru", 40, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_16_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 16, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_16_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 16, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_24_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 24, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_24_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 24, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_32_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 32, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_32_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 32, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_40_Dense8Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 40, "" }, { "dense", 8, "tanh" }, { "dense", 1, "" } });
+}
+
+inline bool is_model_type_ModelType_LSTM_40_Dense16Tanh_1 (const nlohmann::json& model_json) {
+    const auto json_layers = model_json.at ("layers");
+    const auto input_size = model_json.at ("in_shape").back().get<int>();
+    const auto is_input_size_correct = input_size == 1;
+    return is_input_size_correct && is_layers_shape (json_layers, { { "lstm", 40, "" }, { "dense", 16, "tanh" }, { "dense", 1, "" } });
+}
+
+inline int model_family (const nlohmann::json& model_json) {
+    if (is_model_type_ModelType_GRU_8_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_12_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_16_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_20_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_24_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_32_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_GRU_40_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_GRU_64_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_GRU_80_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_LSTM_8_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_12_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_16_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_20_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_24_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_32_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_LSTM_40_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_LSTM_64_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_LSTM_80_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_GRU_2x8_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_2x12_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_2x16_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_2x20_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_2x24_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_2x32_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_LSTM_2x8_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_2x12_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_2x16_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_2x20_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_2x24_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_2x32_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_GRU_16_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_16_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_24_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_24_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_SMALL;
+    if (is_model_type_ModelType_GRU_32_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_GRU_32_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_GRU_40_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_GRU_40_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_GRU_LARGE;
+    if (is_model_type_ModelType_LSTM_16_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_16_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_24_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_24_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (is_model_type_ModelType_LSTM_32_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_LSTM_32_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_LSTM_40_Dense8Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (is_model_type_ModelType_LSTM_40_Dense16Tanh_1 (model_json))
+        return MODEL_FAMILY_LSTM_LARGE;
+    return -1;
+}
+
+inline int model_alias_family (const std::string& alias) {
+    if (alias == "ModelType_GRU_8_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_12_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_16_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_20_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_24_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_32_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_GRU_40_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_GRU_64_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_GRU_80_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_LSTM_8_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_12_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_16_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_20_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_24_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_32_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_LSTM_40_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_LSTM_64_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_LSTM_80_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_GRU_2x8_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_2x12_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_2x16_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_2x20_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_2x24_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_2x32_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_LSTM_2x8_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_2x12_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_2x16_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_2x20_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_2x24_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_2x32_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_GRU_16_Dense8Tanh_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_16_Dense16Tanh_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_24_Dense8Tanh_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_24_Dense16Tanh_1")
+        return MODEL_FAMILY_GRU_SMALL;
+    if (alias == "ModelType_GRU_32_Dense8Tanh_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_GRU_32_Dense16Tanh_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_GRU_40_Dense8Tanh_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_GRU_40_Dense16Tanh_1")
+        return MODEL_FAMILY_GRU_LARGE;
+    if (alias == "ModelType_LSTM_16_Dense8Tanh_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_16_Dense16Tanh_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_24_Dense8Tanh_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_24_Dense16Tanh_1")
+        return MODEL_FAMILY_LSTM_SMALL;
+    if (alias == "ModelType_LSTM_32_Dense8Tanh_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_LSTM_32_Dense16Tanh_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_LSTM_40_Dense8Tanh_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    if (alias == "ModelType_LSTM_40_Dense16Tanh_1")
+        return MODEL_FAMILY_LSTM_LARGE;
+    return -1;
+}
@@ -1,875 +1,301 @@
 #include <variant>
 #include <RTNeural/RTNeural.h>
+#include "activations.hpp"
+#include <model_families.hpp>
 
 #define MAX_INPUT_SIZE 3
-struct NullModel { static constexpr int input_size = 0; static constexpr int output_size = 0; };
-using ModelType_GRU_8_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 8>, RTNeural::DenseT<float, 8, 1>>;
-using ModelType_GRU_8_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 8>, RTNeural::DenseT<float, 8, 1>>;
-using ModelType_GRU_8_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 8>, RTNeural::DenseT<float, 8, 1>>;
-using ModelType_GRU_12_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 12>, RTNeural::DenseT<float, 12, 1>>;
-using ModelType_GRU_12_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 12>, RTNeural::DenseT<float, 12, 1>>;
-using ModelType_GRU_12_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 12>, RTNeural::DenseT<float, 12, 1>>;
-using ModelType_GRU_16_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 16>, RTNeural::DenseT<float, 16, 1>>;
-using ModelType_GRU_16_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 16>, RTNeural::DenseT<float, 16, 1>>;
-using ModelType_GRU_16_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 16>, RTNeural::DenseT<float, 16, 1>>;
-using ModelType_GRU_20_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 20>, RTNeural::DenseT<float, 20, 1>>;
-using ModelType_GRU_20_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 20>, RTNeural::DenseT<float, 20, 1>>;
-using ModelType_GRU_20_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 20>, RTNeural::DenseT<float, 20, 1>>;
-using ModelType_GRU_24_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 24>, RTNeural::DenseT<float, 24, 1>>;
-using ModelType_GRU_24_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 24>, RTNeural::DenseT<float, 24, 1>>;
-using ModelType_GRU_24_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 24>, RTNeural::DenseT<float, 24, 1>>;
-using ModelType_GRU_32_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 32>, RTNeural::DenseT<float, 32, 1>>;
-using ModelType_GRU_32_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 32>, RTNeural::DenseT<float, 32, 1>>;
-using ModelType_GRU_32_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 32>, RTNeural::DenseT<float, 32, 1>>;
-using ModelType_GRU_40_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 40>, RTNeural::DenseT<float, 40, 1>>;
-using ModelType_GRU_40_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 40>, RTNeural::DenseT<float, 40, 1>>;
-using ModelType_GRU_40_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 40>, RTNeural::DenseT<float, 40, 1>>;
-using ModelType_GRU_64_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 64>, RTNeural::DenseT<float, 64, 1>>;
-using ModelType_GRU_64_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 64>, RTNeural::DenseT<float, 64, 1>>;
-using ModelType_GRU_64_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 64>, RTNeural::DenseT<float, 64, 1>>;
-using ModelType_GRU_80_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 80>, RTNeural::DenseT<float, 80, 1>>;
-using ModelType_GRU_80_2 = RTNeural::ModelT<float, 2, 1, RTNeural::GRULayerT<float, 2, 80>, RTNeural::DenseT<float, 80, 1>>;
-using ModelType_GRU_80_3 = RTNeural::ModelT<float, 3, 1, RTNeural::GRULayerT<float, 3, 80>, RTNeural::DenseT<float, 80, 1>>;
-using ModelType_LSTM_8_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 8>, RTNeural::DenseT<float, 8, 1>>;
-using ModelType_LSTM_8_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 8>, RTNeural::DenseT<float, 8, 1>>;
-using ModelType_LSTM_8_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 8>, RTNeural::DenseT<float, 8, 1>>;
-using ModelType_LSTM_12_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 12>, RTNeural::DenseT<float, 12, 1>>;
-using ModelType_LSTM_12_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 12>, RTNeural::DenseT<float, 12, 1>>;
-using ModelType_LSTM_12_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 12>, RTNeural::DenseT<float, 12, 1>>;
-using ModelType_LSTM_16_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 16>, RTNeural::DenseT<float, 16, 1>>;
-using ModelType_LSTM_16_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 16>, RTNeural::DenseT<float, 16, 1>>;
-using ModelType_LSTM_16_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 16>, RTNeural::DenseT<float, 16, 1>>;
-using ModelType_LSTM_20_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 20>, RTNeural::DenseT<float, 20, 1>>;
-using ModelType_LSTM_20_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 20>, RTNeural::DenseT<float, 20, 1>>;
-using ModelType_LSTM_20_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 20>, RTNeural::DenseT<float, 20, 1>>;
-using ModelType_LSTM_24_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 24>, RTNeural::DenseT<float, 24, 1>>;
-using ModelType_LSTM_24_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 24>, RTNeural::DenseT<float, 24, 1>>;
-using ModelType_LSTM_24_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 24>, RTNeural::DenseT<float, 24, 1>>;
-using ModelType_LSTM_32_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 32>, RTNeural::DenseT<float, 32, 1>>;
-using ModelType_LSTM_32_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 32>, RTNeural::DenseT<float, 32, 1>>;
-using ModelType_LSTM_32_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 32>, RTNeural::DenseT<float, 32, 1>>;
-using ModelType_LSTM_40_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 40>, RTNeural::DenseT<float, 40, 1>>;
-using ModelType_LSTM_40_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 40>, RTNeural::DenseT<float, 40, 1>>;
-using ModelType_LSTM_40_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 40>, RTNeural::DenseT<float, 40, 1>>;
-using ModelType_LSTM_64_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 64>, RTNeural::DenseT<float, 64, 1>>;
-using ModelType_LSTM_64_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 64>, RTNeural::DenseT<float, 64, 1>>;
-using ModelType_LSTM_64_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 64>, RTNeural::DenseT<float, 64, 1>>;
-using ModelType_LSTM_80_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 80>, RTNeural::DenseT<float, 80, 1>>;
-using ModelType_LSTM_80_2 = RTNeural::ModelT<float, 2, 1, RTNeural::LSTMLayerT<float, 2, 80>, RTNeural::DenseT<float, 80, 1>>;
-using ModelType_LSTM_80_3 = RTNeural::ModelT<float, 3, 1, RTNeural::LSTMLayerT<float, 3, 80>, RTNeural::DenseT<float, 80, 1>>;
-using ModelVariantType = std::variant<NullModel,ModelType_GRU_8_1,ModelType_GRU_8_2,ModelType_GRU_8_3,ModelType_GRU_12_1,ModelType_GRU_12_2,ModelType_GRU_12_3,ModelType_GRU_16_1,ModelType_GRU_16_2,ModelType_GRU_16_3,ModelType_GRU_20_1,ModelType_GRU_20_2,ModelType_GRU_20_3,ModelType_GRU_24_1,ModelType_GRU_24_2,ModelType_GRU_24_3,ModelType_GRU_32_1,ModelType_GRU_32_2,ModelType_GRU_32_3,ModelType_GRU_40_1,ModelType_GRU_40_2,ModelType_GRU_40_3,ModelType_GRU_64_1,ModelType_GRU_64_2,ModelType_GRU_64_3,ModelType_GRU_80_1,ModelType_GRU_80_2,ModelType_GRU_80_3,ModelType_LSTM_8_1,ModelType_LSTM_8_2,ModelType_LSTM_8_3,ModelType_LSTM_12_1,ModelType_LSTM_12_2,ModelType_LSTM_12_3,ModelType_LSTM_16_1,ModelType_LSTM_16_2,ModelType_LSTM_16_3,ModelType_LSTM_20_1,ModelType_LSTM_20_2,ModelType_LSTM_20_3,ModelType_LSTM_24_1,ModelType_LSTM_24_2,ModelType_LSTM_24_3,ModelType_LSTM_32_1,ModelType_LSTM_32_2,ModelType_LSTM_32_3,ModelType_LSTM_40_1,ModelType_LSTM_40_2,ModelType_LSTM_40_3,ModelType_LSTM_64_1,ModelType_LSTM_64_2,ModelType_LSTM_64_3,ModelType_LSTM_80_1,ModelType_LSTM_80_2,ModelType_LSTM_80_3>;
-
-inline bool is_model_type_ModelType_GRU_8_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 8;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_8_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 8;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_8_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 8;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_12_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 12;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_12_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 12;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_12_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 12;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_16_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 16;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_16_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 16;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_16_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 16;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_20_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 20;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_20_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 20;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_20_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 20;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_24_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 24;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_24_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 24;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_24_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 24;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_32_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 32;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_32_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 32;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_32_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 32;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_40_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 40;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_40_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 40;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_40_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 40;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_64_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 64;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_64_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 64;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_64_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 64;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
 
-inline bool is_model_type_ModelType_GRU_80_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 80;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_80_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 80;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_GRU_80_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "gru";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 80;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_8_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 8;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_8_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 8;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_8_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 8;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_12_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 12;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_12_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 12;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_12_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 12;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_16_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 16;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_16_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 16;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_16_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 16;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_20_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 20;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_20_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 20;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_20_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 20;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_24_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 24;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_24_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 24;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_24_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 24;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_32_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 32;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_32_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 32;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_32_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 32;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_40_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 40;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_40_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 40;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_40_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 40;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_64_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 64;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_64_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 64;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_64_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 64;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_80_1 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 80;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 1;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_80_2 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 80;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 2;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool is_model_type_ModelType_LSTM_80_3 (const nlohmann::json& model_json) {
-    const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "lstm";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == 80;
-    const auto input_size = model_json.at ("in_shape").back().get<int>();
-    const auto is_input_size_correct = input_size == 3;
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
-}
-
-inline bool custom_model_creator (const nlohmann::json& model_json, ModelVariantType& model) {
-    if (is_model_type_ModelType_GRU_8_1 (model_json)) {
-        model.emplace<ModelType_GRU_8_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_8_2 (model_json)) {
-        model.emplace<ModelType_GRU_8_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_8_3 (model_json)) {
-        model.emplace<ModelType_GRU_8_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_12_1 (model_json)) {
-        model.emplace<ModelType_GRU_12_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_12_2 (model_json)) {
-        model.emplace<ModelType_GRU_12_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_12_3 (model_json)) {
-        model.emplace<ModelType_GRU_12_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_16_1 (model_json)) {
-        model.emplace<ModelType_GRU_16_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_16_2 (model_json)) {
-        model.emplace<ModelType_GRU_16_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_16_3 (model_json)) {
-        model.emplace<ModelType_GRU_16_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_20_1 (model_json)) {
-        model.emplace<ModelType_GRU_20_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_20_2 (model_json)) {
-        model.emplace<ModelType_GRU_20_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_20_3 (model_json)) {
-        model.emplace<ModelType_GRU_20_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_24_1 (model_json)) {
-        model.emplace<ModelType_GRU_24_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_24_2 (model_json)) {
-        model.emplace<ModelType_GRU_24_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_24_3 (model_json)) {
-        model.emplace<ModelType_GRU_24_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_32_1 (model_json)) {
-        model.emplace<ModelType_GRU_32_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_32_2 (model_json)) {
-        model.emplace<ModelType_GRU_32_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_32_3 (model_json)) {
-        model.emplace<ModelType_GRU_32_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_40_1 (model_json)) {
-        model.emplace<ModelType_GRU_40_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_40_2 (model_json)) {
-        model.emplace<ModelType_GRU_40_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_40_3 (model_json)) {
-        model.emplace<ModelType_GRU_40_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_64_1 (model_json)) {
-        model.emplace<ModelType_GRU_64_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_64_2 (model_json)) {
-        model.emplace<ModelType_GRU_64_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_64_3 (model_json)) {
-        model.emplace<ModelType_GRU_64_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_80_1 (model_json)) {
-        model.emplace<ModelType_GRU_80_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_80_2 (model_json)) {
-        model.emplace<ModelType_GRU_80_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_GRU_80_3 (model_json)) {
-        model.emplace<ModelType_GRU_80_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_8_1 (model_json)) {
-        model.emplace<ModelType_LSTM_8_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_8_2 (model_json)) {
-        model.emplace<ModelType_LSTM_8_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_8_3 (model_json)) {
-        model.emplace<ModelType_LSTM_8_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_12_1 (model_json)) {
-        model.emplace<ModelType_LSTM_12_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_12_2 (model_json)) {
-        model.emplace<ModelType_LSTM_12_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_12_3 (model_json)) {
-        model.emplace<ModelType_LSTM_12_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_16_1 (model_json)) {
-        model.emplace<ModelType_LSTM_16_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_16_2 (model_json)) {
-        model.emplace<ModelType_LSTM_16_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_16_3 (model_json)) {
-        model.emplace<ModelType_LSTM_16_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_20_1 (model_json)) {
-        model.emplace<ModelType_LSTM_20_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_20_2 (model_json)) {
-        model.emplace<ModelType_LSTM_20_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_20_3 (model_json)) {
-        model.emplace<ModelType_LSTM_20_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_24_1 (model_json)) {
-        model.emplace<ModelType_LSTM_24_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_24_2 (model_json)) {
-        model.emplace<ModelType_LSTM_24_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_24_3 (model_json)) {
-        model.emplace<ModelType_LSTM_24_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_32_1 (model_json)) {
-        model.emplace<ModelType_LSTM_32_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_32_2 (model_json)) {
-        model.emplace<ModelType_LSTM_32_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_32_3 (model_json)) {
-        model.emplace<ModelType_LSTM_32_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_40_1 (model_json)) {
-        model.emplace<ModelType_LSTM_40_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_40_2 (model_json)) {
-        model.emplace<ModelType_LSTM_40_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_40_3 (model_json)) {
-        model.emplace<ModelType_LSTM_40_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_64_1 (model_json)) {
-        model.emplace<ModelType_LSTM_64_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_64_2 (model_json)) {
-        model.emplace<ModelType_LSTM_64_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_64_3 (model_json)) {
-        model.emplace<ModelType_LSTM_64_3>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_80_1 (model_json)) {
-        model.emplace<ModelType_LSTM_80_1>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_80_2 (model_json)) {
-        model.emplace<ModelType_LSTM_80_2>();
-        return true;
-    }
-    else if (is_model_type_ModelType_LSTM_80_3 (model_json)) {
-        model.emplace<ModelType_LSTM_80_3>();
-        return true;
-    }
-    model.emplace<NullModel>();
-    return false;
-}
+namespace RTNeural {
+struct NullModel { static constexpr int input_size = 0; static constexpr int output_size = 0; };
+template <typename LayerType> struct is_lstm_layer : std::false_type {};
+template <typename T, int in_size, int out_size, RTNeural::SampleRateCorrectionMode mode, typename MathsProvider>
+struct is_lstm_layer<RTNeural::LSTMLayerT<T, in_size, out_size, mode, MathsProvider>> : std::true_type {};
+template <typename LayerType> struct is_gru_layer : std::false_type {};
+template <typename T, int in_size, int out_size, RTNeural::SampleRateCorrectionMode mode, typename MathsProvider>
+struct is_gru_layer<RTNeural::GRULayerT<T, in_size, out_size, mode, MathsProvider>> : std::true_type {};
+template <typename LayerType> struct is_dense_layer : std::false_type {};
+template <typename T, int in_size, int out_size>
+struct is_dense_layer<RTNeural::DenseT<T, in_size, out_size>> : std::true_type {};
+template <typename ModelType> struct model_layers_count : std::integral_constant<size_t, 0> {};
+template <typename T, int in_size, int out_size, typename... Layers>
+struct model_layers_count<RTNeural::ModelT<T, in_size, out_size, Layers...>> : std::integral_constant<size_t, sizeof...(Layers)> {};
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_GRU_SMALL
+using ModelType_GRU_8_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 8, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_GRU_12_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 12, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 12, 1>>;
+using ModelType_GRU_16_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_GRU_20_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 20, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 20, 1>>;
+using ModelType_GRU_24_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 1>>;
+using ModelType_GRU_2x8_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 8, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::GRULayerT<float, 8, 8, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_GRU_2x12_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 12, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::GRULayerT<float, 12, 12, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 12, 1>>;
+using ModelType_GRU_2x16_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::GRULayerT<float, 16, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_GRU_2x20_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 20, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::GRULayerT<float, 20, 20, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 20, 1>>;
+using ModelType_GRU_2x24_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::GRULayerT<float, 24, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 1>>;
+using ModelType_GRU_16_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_GRU_16_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_GRU_24_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_GRU_24_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+#define MODEL_VARIANT_TYPES_GRU_SMALL ,ModelType_GRU_8_1,ModelType_GRU_12_1,ModelType_GRU_16_1,ModelType_GRU_20_1,ModelType_GRU_24_1,ModelType_GRU_2x8_1,ModelType_GRU_2x12_1,ModelType_GRU_2x16_1,ModelType_GRU_2x20_1,ModelType_GRU_2x24_1,ModelType_GRU_16_Dense8Tanh_1,ModelType_GRU_16_Dense16Tanh_1,ModelType_GRU_24_Dense8Tanh_1,ModelType_GRU_24_Dense16Tanh_1
+#else
+#define MODEL_VARIANT_TYPES_GRU_SMALL
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_GRU_LARGE
+using ModelType_GRU_32_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 1>>;
+using ModelType_GRU_40_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 40, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 40, 1>>;
+using ModelType_GRU_64_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 64, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 64, 1>>;
+using ModelType_GRU_80_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 80, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 80, 1>>;
+using ModelType_GRU_2x32_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::GRULayerT<float, 32, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 1>>;
+using ModelType_GRU_32_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_GRU_32_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_GRU_40_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 40, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 40, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_GRU_40_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::GRULayerT<float, 1, 40, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 40, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+#define MODEL_VARIANT_TYPES_GRU_LARGE ,ModelType_GRU_32_1,ModelType_GRU_40_1,ModelType_GRU_64_1,ModelType_GRU_80_1,ModelType_GRU_2x32_1,ModelType_GRU_32_Dense8Tanh_1,ModelType_GRU_32_Dense16Tanh_1,ModelType_GRU_40_Dense8Tanh_1,ModelType_GRU_40_Dense16Tanh_1
+#else
+#define MODEL_VARIANT_TYPES_GRU_LARGE
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_LSTM_SMALL
+using ModelType_LSTM_8_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 8, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_LSTM_12_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 12, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 12, 1>>;
+using ModelType_LSTM_16_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_LSTM_20_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 20, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 20, 1>>;
+using ModelType_LSTM_24_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 1>>;
+using ModelType_LSTM_2x8_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 8, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::LSTMLayerT<float, 8, 8, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_LSTM_2x12_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 12, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::LSTMLayerT<float, 12, 12, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 12, 1>>;
+using ModelType_LSTM_2x16_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::LSTMLayerT<float, 16, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_LSTM_2x20_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 20, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::LSTMLayerT<float, 20, 20, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 20, 1>>;
+using ModelType_LSTM_2x24_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::LSTMLayerT<float, 24, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 1>>;
+using ModelType_LSTM_16_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_LSTM_16_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 16, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_LSTM_24_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_LSTM_24_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 24, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 24, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+#define MODEL_VARIANT_TYPES_LSTM_SMALL ,ModelType_LSTM_8_1,ModelType_LSTM_12_1,ModelType_LSTM_16_1,ModelType_LSTM_20_1,ModelType_LSTM_24_1,ModelType_LSTM_2x8_1,ModelType_LSTM_2x12_1,ModelType_LSTM_2x16_1,ModelType_LSTM_2x20_1,ModelType_LSTM_2x24_1,ModelType_LSTM_16_Dense8Tanh_1,ModelType_LSTM_16_Dense16Tanh_1,ModelType_LSTM_24_Dense8Tanh_1,ModelType_LSTM_24_Dense16Tanh_1
+#else
+#define MODEL_VARIANT_TYPES_LSTM_SMALL
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_LSTM_LARGE
+using ModelType_LSTM_32_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 1>>;
+using ModelType_LSTM_40_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 40, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 40, 1>>;
+using ModelType_LSTM_64_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 64, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 64, 1>>;
+using ModelType_LSTM_80_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 80, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 80, 1>>;
+using ModelType_LSTM_2x32_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::LSTMLayerT<float, 32, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 1>>;
+using ModelType_LSTM_32_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_LSTM_32_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 32, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 32, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+using ModelType_LSTM_40_Dense8Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 40, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 40, 8>, RTNeural::TanhActivationT<float, 8, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 8, 1>>;
+using ModelType_LSTM_40_Dense16Tanh_1 = RTNeural::ModelT<float, 1, 1, RTNeural::LSTMLayerT<float, 1, 40, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 40, 16>, RTNeural::TanhActivationT<float, 16, RTNeural::ActivationMathsProvider>, RTNeural::DenseT<float, 16, 1>>;
+#define MODEL_VARIANT_TYPES_LSTM_LARGE ,ModelType_LSTM_32_1,ModelType_LSTM_40_1,ModelType_LSTM_64_1,ModelType_LSTM_80_1,ModelType_LSTM_2x32_1,ModelType_LSTM_32_Dense8Tanh_1,ModelType_LSTM_32_Dense16Tanh_1,ModelType_LSTM_40_Dense8Tanh_1,ModelType_LSTM_40_Dense16Tanh_1
+#else
+#define MODEL_VARIANT_TYPES_LSTM_LARGE
+#endif
+using ModelVariantType = std::variant<NullModel MODEL_VARIANT_TYPES_GRU_SMALL MODEL_VARIANT_TYPES_GRU_LARGE MODEL_VARIANT_TYPES_LSTM_SMALL MODEL_VARIANT_TYPES_LSTM_LARGE>;
+
+template <typename ModelType> struct ModelTypeTag { using type = ModelType; const char* name; };
+template <typename Create>
+inline decltype(auto) create_custom_model (const nlohmann::json& model_json, Create&& create) {
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_GRU_SMALL
+    if (is_model_type_ModelType_GRU_8_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_8_1>{ "ModelType_GRU_8_1" });
+    if (is_model_type_ModelType_GRU_12_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_12_1>{ "ModelType_GRU_12_1" });
+    if (is_model_type_ModelType_GRU_16_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_16_1>{ "ModelType_GRU_16_1" });
+    if (is_model_type_ModelType_GRU_20_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_20_1>{ "ModelType_GRU_20_1" });
+    if (is_model_type_ModelType_GRU_24_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_24_1>{ "ModelType_GRU_24_1" });
+    if (is_model_type_ModelType_GRU_2x8_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_2x8_1>{ "ModelType_GRU_2x8_1" });
+    if (is_model_type_ModelType_GRU_2x12_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_2x12_1>{ "ModelType_GRU_2x12_1" });
+    if (is_model_type_ModelType_GRU_2x16_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_2x16_1>{ "ModelType_GRU_2x16_1" });
+    if (is_model_type_ModelType_GRU_2x20_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_2x20_1>{ "ModelType_GRU_2x20_1" });
+    if (is_model_type_ModelType_GRU_2x24_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_2x24_1>{ "ModelType_GRU_2x24_1" });
+    if (is_model_type_ModelType_GRU_16_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_16_Dense8Tanh_1>{ "ModelType_GRU_16_Dense8Tanh_1" });
+    if (is_model_type_ModelType_GRU_16_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_16_Dense16Tanh_1>{ "ModelType_GRU_16_Dense16Tanh_1" });
+    if (is_model_type_ModelType_GRU_24_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_24_Dense8Tanh_1>{ "ModelType_GRU_24_Dense8Tanh_1" });
+    if (is_model_type_ModelType_GRU_24_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_24_Dense16Tanh_1>{ "ModelType_GRU_24_Dense16Tanh_1" });
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_GRU_LARGE
+    if (is_model_type_ModelType_GRU_32_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_32_1>{ "ModelType_GRU_32_1" });
+    if (is_model_type_ModelType_GRU_40_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_40_1>{ "ModelType_GRU_40_1" });
+    if (is_model_type_ModelType_GRU_64_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_64_1>{ "ModelType_GRU_64_1" });
+    if (is_model_type_ModelType_GRU_80_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_80_1>{ "ModelType_GRU_80_1" });
+    if (is_model_type_ModelType_GRU_2x32_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_2x32_1>{ "ModelType_GRU_2x32_1" });
+    if (is_model_type_ModelType_GRU_32_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_32_Dense8Tanh_1>{ "ModelType_GRU_32_Dense8Tanh_1" });
+    if (is_model_type_ModelType_GRU_32_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_32_Dense16Tanh_1>{ "ModelType_GRU_32_Dense16Tanh_1" });
+    if (is_model_type_ModelType_GRU_40_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_40_Dense8Tanh_1>{ "ModelType_GRU_40_Dense8Tanh_1" });
+    if (is_model_type_ModelType_GRU_40_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_GRU_40_Dense16Tanh_1>{ "ModelType_GRU_40_Dense16Tanh_1" });
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_LSTM_SMALL
+    if (is_model_type_ModelType_LSTM_8_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_8_1>{ "ModelType_LSTM_8_1" });
+    if (is_model_type_ModelType_LSTM_12_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_12_1>{ "ModelType_LSTM_12_1" });
+    if (is_model_type_ModelType_LSTM_16_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_16_1>{ "ModelType_LSTM_16_1" });
+    if (is_model_type_ModelType_LSTM_20_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_20_1>{ "ModelType_LSTM_20_1" });
+    if (is_model_type_ModelType_LSTM_24_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_24_1>{ "ModelType_LSTM_24_1" });
+    if (is_model_type_ModelType_LSTM_2x8_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_2x8_1>{ "ModelType_LSTM_2x8_1" });
+    if (is_model_type_ModelType_LSTM_2x12_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_2x12_1>{ "ModelType_LSTM_2x12_1" });
+    if (is_model_type_ModelType_LSTM_2x16_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_2x16_1>{ "ModelType_LSTM_2x16_1" });
+    if (is_model_type_ModelType_LSTM_2x20_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_2x20_1>{ "ModelType_LSTM_2x20_1" });
+    if (is_model_type_ModelType_LSTM_2x24_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_2x24_1>{ "ModelType_LSTM_2x24_1" });
+    if (is_model_type_ModelType_LSTM_16_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_16_Dense8Tanh_1>{ "ModelType_LSTM_16_Dense8Tanh_1" });
+    if (is_model_type_ModelType_LSTM_16_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_16_Dense16Tanh_1>{ "ModelType_LSTM_16_Dense16Tanh_1" });
+    if (is_model_type_ModelType_LSTM_24_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_24_Dense8Tanh_1>{ "ModelType_LSTM_24_Dense8Tanh_1" });
+    if (is_model_type_ModelType_LSTM_24_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_24_Dense16Tanh_1>{ "ModelType_LSTM_24_Dense16Tanh_1" });
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_LSTM_LARGE
+    if (is_model_type_ModelType_LSTM_32_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_32_1>{ "ModelType_LSTM_32_1" });
+    if (is_model_type_ModelType_LSTM_40_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_40_1>{ "ModelType_LSTM_40_1" });
+    if (is_model_type_ModelType_LSTM_64_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_64_1>{ "ModelType_LSTM_64_1" });
+    if (is_model_type_ModelType_LSTM_80_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_80_1>{ "ModelType_LSTM_80_1" });
+    if (is_model_type_ModelType_LSTM_2x32_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_2x32_1>{ "ModelType_LSTM_2x32_1" });
+    if (is_model_type_ModelType_LSTM_32_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_32_Dense8Tanh_1>{ "ModelType_LSTM_32_Dense8Tanh_1" });
+    if (is_model_type_ModelType_LSTM_32_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_32_Dense16Tanh_1>{ "ModelType_LSTM_32_Dense16Tanh_1" });
+    if (is_model_type_ModelType_LSTM_40_Dense8Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_40_Dense8Tanh_1>{ "ModelType_LSTM_40_Dense8Tanh_1" });
+    if (is_model_type_ModelType_LSTM_40_Dense16Tanh_1 (model_json))
+        return create (ModelTypeTag<ModelType_LSTM_40_Dense16Tanh_1>{ "ModelType_LSTM_40_Dense16Tanh_1" });
+#endif
+    return create (ModelTypeTag<NullModel>{ nullptr });
+}
+
+template <typename Create>
+inline decltype(auto) create_custom_model_named (const std::string& name, Create&& create) {
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_GRU_SMALL
+    if (name == "ModelType_GRU_8_1")
+        return create (ModelTypeTag<ModelType_GRU_8_1>{ "ModelType_GRU_8_1" });
+    if (name == "ModelType_GRU_12_1")
+        return create (ModelTypeTag<ModelType_GRU_12_1>{ "ModelType_GRU_12_1" });
+    if (name == "ModelType_GRU_16_1")
+        return create (ModelTypeTag<ModelType_GRU_16_1>{ "ModelType_GRU_16_1" });
+    if (name == "ModelType_GRU_20_1")
+        return create (ModelTypeTag<ModelType_GRU_20_1>{ "ModelType_GRU_20_1" });
+    if (name == "ModelType_GRU_24_1")
+        return create (ModelTypeTag<ModelType_GRU_24_1>{ "ModelType_GRU_24_1" });
+    if (name == "ModelType_GRU_2x8_1")
+        return create (ModelTypeTag<ModelType_GRU_2x8_1>{ "ModelType_GRU_2x8_1" });
+    if (name == "ModelType_GRU_2x12_1")
+        return create (ModelTypeTag<ModelType_GRU_2x12_1>{ "ModelType_GRU_2x12_1" });
+    if (name == "ModelType_GRU_2x16_1")
+        return create (ModelTypeTag<ModelType_GRU_2x16_1>{ "ModelType_GRU_2x16_1" });
+    if (name == "ModelType_GRU_2x20_1")
+        return create (ModelTypeTag<ModelType_GRU_2x20_1>{ "ModelType_GRU_2x20_1" });
+    if (name == "ModelType_GRU_2x24_1")
+        return create (ModelTypeTag<ModelType_GRU_2x24_1>{ "ModelType_GRU_2x24_1" });
+    if (name == "ModelType_GRU_16_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_16_Dense8Tanh_1>{ "ModelType_GRU_16_Dense8Tanh_1" });
+    if (name == "ModelType_GRU_16_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_16_Dense16Tanh_1>{ "ModelType_GRU_16_Dense16Tanh_1" });
+    if (name == "ModelType_GRU_24_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_24_Dense8Tanh_1>{ "ModelType_GRU_24_Dense8Tanh_1" });
+    if (name == "ModelType_GRU_24_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_24_Dense16Tanh_1>{ "ModelType_GRU_24_Dense16Tanh_1" });
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_GRU_LARGE
+    if (name == "ModelType_GRU_32_1")
+        return create (ModelTypeTag<ModelType_GRU_32_1>{ "ModelType_GRU_32_1" });
+    if (name == "ModelType_GRU_40_1")
+        return create (ModelTypeTag<ModelType_GRU_40_1>{ "ModelType_GRU_40_1" });
+    if (name == "ModelType_GRU_64_1")
+        return create (ModelTypeTag<ModelType_GRU_64_1>{ "ModelType_GRU_64_1" });
+    if (name == "ModelType_GRU_80_1")
+        return create (ModelTypeTag<ModelType_GRU_80_1>{ "ModelType_GRU_80_1" });
+    if (name == "ModelType_GRU_2x32_1")
+        return create (ModelTypeTag<ModelType_GRU_2x32_1>{ "ModelType_GRU_2x32_1" });
+    if (name == "ModelType_GRU_32_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_32_Dense8Tanh_1>{ "ModelType_GRU_32_Dense8Tanh_1" });
+    if (name == "ModelType_GRU_32_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_32_Dense16Tanh_1>{ "ModelType_GRU_32_Dense16Tanh_1" });
+    if (name == "ModelType_GRU_40_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_40_Dense8Tanh_1>{ "ModelType_GRU_40_Dense8Tanh_1" });
+    if (name == "ModelType_GRU_40_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_GRU_40_Dense16Tanh_1>{ "ModelType_GRU_40_Dense16Tanh_1" });
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_LSTM_SMALL
+    if (name == "ModelType_LSTM_8_1")
+        return create (ModelTypeTag<ModelType_LSTM_8_1>{ "ModelType_LSTM_8_1" });
+    if (name == "ModelType_LSTM_12_1")
+        return create (ModelTypeTag<ModelType_LSTM_12_1>{ "ModelType_LSTM_12_1" });
+    if (name == "ModelType_LSTM_16_1")
+        return create (ModelTypeTag<ModelType_LSTM_16_1>{ "ModelType_LSTM_16_1" });
+    if (name == "ModelType_LSTM_20_1")
+        return create (ModelTypeTag<ModelType_LSTM_20_1>{ "ModelType_LSTM_20_1" });
+    if (name == "ModelType_LSTM_24_1")
+        return create (ModelTypeTag<ModelType_LSTM_24_1>{ "ModelType_LSTM_24_1" });
+    if (name == "ModelType_LSTM_2x8_1")
+        return create (ModelTypeTag<ModelType_LSTM_2x8_1>{ "ModelType_LSTM_2x8_1" });
+    if (name == "ModelType_LSTM_2x12_1")
+        return create (ModelTypeTag<ModelType_LSTM_2x12_1>{ "ModelType_LSTM_2x12_1" });
+    if (name == "ModelType_LSTM_2x16_1")
+        return create (ModelTypeTag<ModelType_LSTM_2x16_1>{ "ModelType_LSTM_2x16_1" });
+    if (name == "ModelType_LSTM_2x20_1")
+        return create (ModelTypeTag<ModelType_LSTM_2x20_1>{ "ModelType_LSTM_2x20_1" });
+    if (name == "ModelType_LSTM_2x24_1")
+        return create (ModelTypeTag<ModelType_LSTM_2x24_1>{ "ModelType_LSTM_2x24_1" });
+    if (name == "ModelType_LSTM_16_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_16_Dense8Tanh_1>{ "ModelType_LSTM_16_Dense8Tanh_1" });
+    if (name == "ModelType_LSTM_16_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_16_Dense16Tanh_1>{ "ModelType_LSTM_16_Dense16Tanh_1" });
+    if (name == "ModelType_LSTM_24_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_24_Dense8Tanh_1>{ "ModelType_LSTM_24_Dense8Tanh_1" });
+    if (name == "ModelType_LSTM_24_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_24_Dense16Tanh_1>{ "ModelType_LSTM_24_Dense16Tanh_1" });
+#endif
+#if !defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_LSTM_LARGE
+    if (name == "ModelType_LSTM_32_1")
+        return create (ModelTypeTag<ModelType_LSTM_32_1>{ "ModelType_LSTM_32_1" });
+    if (name == "ModelType_LSTM_40_1")
+        return create (ModelTypeTag<ModelType_LSTM_40_1>{ "ModelType_LSTM_40_1" });
+    if (name == "ModelType_LSTM_64_1")
+        return create (ModelTypeTag<ModelType_LSTM_64_1>{ "ModelType_LSTM_64_1" });
+    if (name == "ModelType_LSTM_80_1")
+        return create (ModelTypeTag<ModelType_LSTM_80_1>{ "ModelType_LSTM_80_1" });
+    if (name == "ModelType_LSTM_2x32_1")
+        return create (ModelTypeTag<ModelType_LSTM_2x32_1>{ "ModelType_LSTM_2x32_1" });
+    if (name == "ModelType_LSTM_32_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_32_Dense8Tanh_1>{ "ModelType_LSTM_32_Dense8Tanh_1" });
+    if (name == "ModelType_LSTM_32_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_32_Dense16Tanh_1>{ "ModelType_LSTM_32_Dense16Tanh_1" });
+    if (name == "ModelType_LSTM_40_Dense8Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_40_Dense8Tanh_1>{ "ModelType_LSTM_40_Dense8Tanh_1" });
+    if (name == "ModelType_LSTM_40_Dense16Tanh_1")
+        return create (ModelTypeTag<ModelType_LSTM_40_Dense16Tanh_1>{ "ModelType_LSTM_40_Dense16Tanh_1" });
+#endif
+    return create (ModelTypeTag<NullModel>{ nullptr });
+}
+
+} // namespace RTNeural
@@ -0,0 +1,199 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "pipeline.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+/* Spin wait hint, keeps the polling core from hogging its sibling and the memory bus */
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+ModelPipeline::ModelPipeline()
+    : next_block(0),
+      in_flight(false),
+      submitted(0),
+      completed(0),
+      quit(false),
+      parked(false),
+      thread_started(false),
+      callback(nullptr),
+      callback_arg(nullptr),
+      n_cpus(1),
+      pinned_cpu(-1)
+{
+    sem_init(&wakeup, 0, 0);
+}
+
+ModelPipeline::~ModelPipeline()
+{
+    stop();
+    sem_destroy(&wakeup);
+}
+
+bool ModelPipeline::start(PipelineCallback cb, void* arg)
+{
+    if (thread_started) {
+        if (parked)
+            sem_post(&wakeup);
+        return true;
+    }
+
+    n_cpus = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    if (n_cpus < 2)
+        return false;
+
+    callback = cb;
+    callback_arg = arg;
+    quit = false;
+    parked = false;
+    thread_started = pthread_create(&thread, nullptr, threadFunction, this) == 0;
+    return thread_started;
+}
+
+void ModelPipeline::stop()
+{
+    if (!thread_started)
+        return;
+
+    quit = true;
+    sem_post(&wakeup);
+    pthread_join(thread, nullptr);
+    thread_started = false;
+    reset();
+}
+
+void ModelPipeline::sync()
+{
+    const uint64_t target = submitted.load(std::memory_order_acquire);
+    while (thread_started && completed.load(std::memory_order_acquire) < target) {
+        if (parked)
+            sem_post(&wakeup); /* Block left to a helper that parked meanwhile */
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+void ModelPipeline::reset()
+{
+    sync();
+    PipelineBlock* block;
+    while (results.pop(block)) {
+    }
+    in_flight = false;
+}
+
+void ModelPipeline::submit()
+{
+    PipelineBlock* block = &blocks[next_block];
+    if (!jobs.push(block))
+        return;
+    submitted.fetch_add(1, std::memory_order_release);
+    /* Pairs with the helper parking: either it sees the block or running() sees it parked */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    next_block ^= 1;
+    in_flight = true;
+}
+
+PipelineBlock* ModelPipeline::collect()
+{
+    PipelineBlock* block = nullptr;
+    if (in_flight && results.pop(block))
+        in_flight = false;
+    return block;
+}
+
+/**
+ * Keeps the helper off the audio thread core and at its priority. This is done on first block
+ * rather than at start, the audio thread is only known once it has run.
+ */
+void ModelPipeline::configureThread(const PipelineBlock& block)
+{
+    if (block.host_cpu >= 0 && (pinned_cpu < 0 || pinned_cpu == block.host_cpu)) {
+        const int cpu = (block.host_cpu + 1) % n_cpus;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0)
+            pinned_cpu = cpu;
+        else
+            pinned_cpu = block.host_cpu + n_cpus; /* Don't try again */
+
+        int policy;
+        struct sched_param param;
+        if (pthread_getschedparam(block.host_thread, &policy, &param) == 0 && (policy == SCHED_FIFO || policy == SCHED_RR))
+            pthread_setschedparam(pthread_self(), policy, &param);
+    }
+}
+
+/**
+ * Polls the job ring: spins for PIPELINE_SPIN_COUNT polls, yields for PIPELINE_YIELD_COUNT more,
+ * then sleeps between polls, doubling up to PIPELINE_MAX_SLEEP_US. Idle for PIPELINE_PARK_MS, e.g.
+ * with the mode turned off, it parks on the semaphore until start or stop post it.
+ */
+void* ModelPipeline::threadFunction(void* arg)
+{
+    ModelPipeline* self = static_cast<ModelPipeline*>(arg);
+    uint32_t idle_polls = 0;
+    uint32_t sleep_us = 1;
+    auto idle_since = std::chrono::steady_clock::now();
+
+    while (!self->quit.load(std::memory_order_acquire)) {
+        PipelineBlock* block;
+        if (self->jobs.pop(block)) {
+            const auto start = std::chrono::steady_clock::now();
+            self->configureThread(*block);
+            self->callback(self->callback_arg, *block);
+            idle_since = std::chrono::steady_clock::now();
+            block->elapsed = std::chrono::duration<float>(idle_since - start).count();
+            self->results.push(block);
+            self->completed.fetch_add(1, std::memory_order_release);
+            idle_polls = 0;
+            sleep_us = 1;
+            continue;
+        }
+
+        if (idle_polls < PIPELINE_SPIN_COUNT) {
+            cpuRelax();
+        } else if (idle_polls < PIPELINE_SPIN_COUNT + PIPELINE_YIELD_COUNT) {
+            sched_yield();
+        } else if (std::chrono::steady_clock::now() - idle_since < std::chrono::milliseconds(PIPELINE_PARK_MS)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+            sleep_us = std::min<uint32_t>(sleep_us * 2, PIPELINE_MAX_SLEEP_US);
+        } else {
+            /* Pairs with submit: either the block is seen here or the audio thread sees it parked */
+            self->parked.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (self->jobs.empty() && !self->quit.load(std::memory_order_acquire)) {
+                while (sem_wait(&self->wakeup) != 0 && errno == EINTR) {
+                }
+            }
+            self->parked.store(false, std::memory_order_seq_cst);
+            idle_since = std::chrono::steady_clock::now();
+            idle_polls = 0;
+            sleep_us = 1;
+            continue;
+        }
+        idle_polls++;
+    }
+
+    /* Nothing gets submitted once stopping, account for what is left */
+    PipelineBlock* block;
+    while (self->jobs.pop(block))
+        self->completed.fetch_add(1, std::memory_order_release);
+
+    return nullptr;
+}
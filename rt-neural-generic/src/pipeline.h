@@ -0,0 +1,98 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "spsc-ring.h"
+
+/* Largest period the pipeline takes, longer ones are processed inline */
+#define PIPELINE_MAX_BLOCK 4096
+
+/* Helper polling for blocks: spins, then yields, then sleeps up to this long between polls */
+#define PIPELINE_SPIN_COUNT 2000
+#define PIPELINE_YIELD_COUNT 50
+#define PIPELINE_MAX_SLEEP_US 50
+/* Idle time after which the helper parks until woken from a non realtime thread */
+#define PIPELINE_PARK_MS 200
+
+struct DynamicModel;
+
+/* One period of audio on its way through the model, with everything the model stage needs */
+struct PipelineBlock {
+    float samples[PIPELINE_MAX_BLOCK];
+    uint32_t n_samples;
+    DynamicModel* model;
+    float param1;
+    float param2;
+    bool restart; /* Model switched, start it from its warm state first */
+    int host_cpu; /* Core the audio thread ran on, the helper stays off it */
+    pthread_t host_thread; /* Audio thread, the helper takes its scheduling policy and priority */
+    float elapsed; /* Seconds the helper spent on the block */
+};
+
+typedef void (*PipelineCallback)(void* arg, PipelineBlock& block);
+
+/**
+ * Runs the model stage on a helper thread, one period behind the audio thread. The audio thread
+ * submits the block it has just filled and collects the one submitted on previous run, so at most
+ * one block is in flight and two blocks are enough. The helper pins itself to a core other than the
+ * audio thread one and runs at its priority.
+ *
+ * The audio thread never makes a syscall to hand a block over: the helper polls the job ring with
+ * a bounded backoff. Idle for PIPELINE_PARK_MS it parks on a semaphore, and the audio thread has a
+ * non realtime thread wake it, processing inline meanwhile.
+ */
+class ModelPipeline
+{
+public:
+    ModelPipeline();
+    ~ModelPipeline();
+
+    /* Non realtime, starts the helper or wakes it up when parked, false when it can't run, e.g. on a single core */
+    bool start(PipelineCallback callback, void* arg);
+    void stop();
+    /* Non realtime, waits for blocks submitted so far to be processed */
+    void sync();
+    /* Non realtime, drops the block in flight */
+    void reset();
+
+    /* Realtime, helper started and not parked */
+    bool running() const { return thread_started.load(std::memory_order_acquire) && !parked.load(std::memory_order_seq_cst); }
+    /* Realtime, audio thread only */
+    bool pending() const { return in_flight; }
+    PipelineBlock* input() { return &blocks[next_block]; }
+    void submit();
+    PipelineBlock* collect();
+
+private:
+    static void* threadFunction(void* arg);
+    void configureThread(const PipelineBlock& block);
+
+    PipelineBlock blocks[2];
+    int next_block;
+    bool in_flight;
+    SpscRing<PipelineBlock*, 2> jobs;
+    SpscRing<PipelineBlock*, 2> results;
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> completed;
+    std::atomic<bool> quit;
+    std::atomic<bool> parked; /* Helper waits on wakeup, polls the job ring otherwise */
+    sem_t wakeup;
+    pthread_t thread;
+    std::atomic<bool> thread_started;
+    PipelineCallback callback;
+    void* callback_arg;
+    int n_cpus;
+    int pinned_cpu; /* Helper thread only, -1 until pinned */
+};
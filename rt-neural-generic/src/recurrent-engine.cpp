@@ -0,0 +1,879 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * Recurrent models with structured recurrent kernels, the per-sample bottleneck of bigger models.
+ * Layers are laid out and computed as RTNeural does for Keras models (LSTM gates i, f, c, o and
+ * GRU gates z, r, h with reset after), only the recurrent kernel representation changes:
+ *
+ * - Block-sparse, for pruned models. Kernels are stored as rows of 1 x SPARSE_BLOCK blocks along
+ *   the gates, only blocks with a non zero weight are kept and each one is a fixed size multiply-add
+ *   the compiler vectorizes. A recurrent layer can carry an explicit "mask", shaped as its recurrent
+ *   kernel, zeroing the weights that have been pruned, otherwise sparsity is detected from weights.
+ *
+ * - Low-rank, the kernel is the product of two thin matrices. A recurrent layer can carry them as
+ *   "recurrent_factors": [ hidden_size x rank, rank x gates ], otherwise they are computed at load
+ *   time with the lowest rank keeping the model within LOWRANK_ESR_BUDGET on its input_batch.
+ */
+
+#include "rt-neural-generic.h"
+
+/* Weights per block, a multiple of the SIMD width */
+#define SPARSE_BLOCK 8
+
+/* Share of empty blocks in recurrent kernels over which the sparse engine is worth a try */
+#define SPARSE_MIN_EMPTY_BLOCKS 0.5f
+
+/* Recurrent layers smaller than this are not worth a low-rank factorization */
+#define LOWRANK_MIN_HIDDEN_SIZE 32
+/* Ranks tried, in steps of */
+#define LOWRANK_RANK_STEP 8
+/* Error to signal ratio the factorization can add on input_batch */
+#define LOWRANK_ESR_BUDGET 1.0e-3
+
+namespace {
+
+int paddedSize(int size)
+{
+    return (size + SPARSE_BLOCK - 1) / SPARSE_BLOCK * SPARSE_BLOCK;
+}
+
+/* Rows x cols matrix, cols padded to a multiple of SPARSE_BLOCK, non zero blocks only */
+struct SparseMatrix {
+    explicit SparseMatrix(ModelArena& arena) : row_start(arena), block_col(arena), values(arena) {}
+
+    int rows;
+    int cols;
+    EngineVector<int> row_start; /* rows + 1 offsets into block_col */
+    EngineVector<int> block_col; /* First column of each block */
+    EngineVector<float> values; /* SPARSE_BLOCK weights per block */
+
+    void assign(const std::vector<std::vector<float>>& matrix);
+    /* y += x * matrix, y holds cols rounded up to SPARSE_BLOCK */
+    void multiply(const float* x, float* y);
+    void serialize(ModelImage& image) const;
+    void restore(ModelImageReader& image);
+    void getMemoryRegions(MemoryRegions& regions) const
+    {
+        addMemoryRegion(regions, row_start);
+        addMemoryRegion(regions, block_col);
+        addMemoryRegion(regions, values);
+    }
+};
+
+void SparseMatrix::assign(const std::vector<std::vector<float>>& matrix)
+{
+    rows = matrix.size();
+    cols = rows > 0 ? matrix[0].size() : 0;
+    std::vector<int> starts(1, 0);
+    std::vector<int> cols_start;
+    std::vector<float> blocks;
+    for (const auto& row : matrix) {
+        for (int col = 0; col < cols; col += SPARSE_BLOCK) {
+            const int end = std::min(col + SPARSE_BLOCK, cols);
+            if (std::all_of(row.begin() + col, row.begin() + end, [](float w) { return w == 0.0f; }))
+                continue;
+            cols_start.push_back(col);
+            blocks.insert(blocks.end(), row.begin() + col, row.begin() + end);
+            blocks.resize(cols_start.size() * SPARSE_BLOCK, 0.0f);
+        }
+        starts.push_back(cols_start.size());
+    }
+    /* Arena buffers don't give memory back as they grow, they are filled once at their final size */
+    row_start.assign(starts.begin(), starts.end());
+    block_col.assign(cols_start.begin(), cols_start.end());
+    values.assign(blocks.begin(), blocks.end());
+}
+
+void SparseMatrix::serialize(ModelImage& image) const
+{
+    image.put(rows);
+    image.put(cols);
+    image.putVector(row_start);
+    image.putVector(block_col);
+    image.putVector(values);
+}
+
+void SparseMatrix::restore(ModelImageReader& image)
+{
+    rows = image.get<int>();
+    cols = image.get<int>();
+    image.getVector(row_start);
+    image.getVector(block_col);
+    image.getVector(values);
+    if (static_cast<int>(row_start.size()) != rows + 1 || values.size() != block_col.size() * SPARSE_BLOCK
+        || row_start.back() != static_cast<int>(block_col.size()))
+        throw std::runtime_error("Bad sparse matrix image");
+}
+
+void SparseMatrix::multiply(const float* x, float* y)
+{
+    for (int row = 0; row < rows; row++) {
+        const float xr = x[row];
+        for (int b = row_start[row]; b < row_start[row + 1]; b++) {
+            const float* w = values.data() + b * SPARSE_BLOCK;
+            float* yb = y + block_col[b];
+            for (int k = 0; k < SPARSE_BLOCK; k++)
+                yb[k] += w[k] * xr;
+        }
+    }
+}
+
+/* Rows x cols matrix as left (rows x rank) times right (rank x cols padded to SPARSE_BLOCK) */
+struct LowRankMatrix {
+    explicit LowRankMatrix(ModelArena& arena) : left(arena), right(arena), t(arena) {}
+
+    int rows;
+    int cols;
+    int rank;
+    EngineVector<float> left;
+    EngineVector<float> right;
+    EngineVector<float> t; /* rank scratch, x * left */
+
+    void assign(const std::vector<std::vector<float>>& left, const std::vector<std::vector<float>>& right);
+    /* y += x * left * right, y holds cols rounded up to SPARSE_BLOCK */
+    void multiply(const float* x, float* y);
+    void serialize(ModelImage& image) const;
+    void restore(ModelImageReader& image);
+    void getMemoryRegions(MemoryRegions& regions) const
+    {
+        addMemoryRegion(regions, left);
+        addMemoryRegion(regions, right);
+        addMemoryRegion(regions, t);
+    }
+};
+
+void LowRankMatrix::assign(const std::vector<std::vector<float>>& left_factor, const std::vector<std::vector<float>>& right_factor)
+{
+    rows = left_factor.size();
+    rank = right_factor.size();
+    cols = rank > 0 ? right_factor[0].size() : 0;
+    left.assign(rows * rank, 0.0f);
+    for (int i = 0; i < rows; i++) {
+        if (static_cast<int>(left_factor[i].size()) != rank)
+            throw std::invalid_argument("Recurrent factors do not match");
+        std::copy(left_factor[i].begin(), left_factor[i].end(), left.begin() + i * rank);
+    }
+    right.assign(rank * paddedSize(cols), 0.0f);
+    for (int k = 0; k < rank; k++)
+        std::copy(right_factor[k].begin(), right_factor[k].end(), right.begin() + k * paddedSize(cols));
+    t.assign(rank, 0.0f);
+}
+
+void LowRankMatrix::serialize(ModelImage& image) const
+{
+    image.put(rows);
+    image.put(cols);
+    image.put(rank);
+    image.putVector(left);
+    image.putVector(right);
+}
+
+void LowRankMatrix::restore(ModelImageReader& image)
+{
+    rows = image.get<int>();
+    cols = image.get<int>();
+    rank = image.get<int>();
+    image.getVector(left);
+    image.getVector(right);
+    if (static_cast<int>(left.size()) != rows * rank || static_cast<int>(right.size()) != rank * paddedSize(cols))
+        throw std::runtime_error("Bad low-rank matrix image");
+    t.assign(rank, 0.0f);
+}
+
+void LowRankMatrix::multiply(const float* x, float* y)
+{
+    const int padded_cols = paddedSize(cols);
+    std::fill(t.begin(), t.end(), 0.0f);
+    for (int row = 0; row < rows; row++) {
+        const float xr = x[row];
+        const float* w = left.data() + row * rank;
+        for (int k = 0; k < rank; k++)
+            t[k] += w[k] * xr;
+    }
+    for (int k = 0; k < rank; k++) {
+        const float tk = t[k];
+        const float* w = right.data() + k * padded_cols;
+        for (int c = 0; c < padded_cols; c++)
+            y[c] += w[c] * tk;
+    }
+}
+
+inline float sigmoid(float x)
+{
+    return 0.5f * tanhf(0.5f * x) + 0.5f;
+}
+
+/* Recurrent kernel with the layer mask applied, if any */
+std::vector<std::vector<float>> recurrentKernel(const nlohmann::json& json_layer)
+{
+    std::vector<std::vector<float>> kernel = json_layer.at("weights").at(1);
+    if (json_layer.contains("mask")) {
+        const std::vector<std::vector<float>> mask = json_layer.at("mask");
+        if (mask.size() != kernel.size())
+            throw std::invalid_argument("Mask does not match recurrent kernel");
+        for (size_t i = 0; i < kernel.size(); i++) {
+            if (mask[i].size() != kernel[i].size())
+                throw std::invalid_argument("Mask does not match recurrent kernel");
+            for (size_t j = 0; j < kernel[i].size(); j++)
+                kernel[i][j] *= mask[i][j] != 0.0f;
+        }
+    }
+    return kernel;
+}
+
+/* Rows of matrix one after the other, at least size elements padded with zeros */
+void assignFlat(EngineVector<float>& buffer, const std::vector<std::vector<float>>& matrix, size_t size = 0)
+{
+    size_t n = 0;
+    for (const auto& row : matrix)
+        n += row.size();
+    buffer.assign(std::max(n, size), 0.0f);
+    auto it = buffer.begin();
+    for (const auto& row : matrix)
+        it = std::copy(row.begin(), row.end(), it);
+}
+
+template <typename Matrix>
+struct RecurrentLayer {
+    explicit RecurrentLayer(ModelArena& arena)
+        : kernel(arena), recurrent(arena), bias(arena), recurrent_bias(arena), h(arena), c(arena), warm_h(arena), warm_c(arena), gates(arena), rgates(arena) {}
+
+    bool lstm;
+    int in_size;
+    int hidden_size;
+    int gates_size;
+    EngineVector<float> kernel; /* in_size x gates_size, dense */
+    Matrix recurrent;
+    EngineVector<float> bias; /* gates_size */
+    EngineVector<float> recurrent_bias; /* gates_size, GRU only */
+    EngineVector<float> h;
+    EngineVector<float> c; /* LSTM only */
+    EngineVector<float> warm_h; /* Copies of h and c, see saveState */
+    EngineVector<float> warm_c;
+    EngineVector<float> gates; /* Padded scratch for input contribution */
+    EngineVector<float> rgates; /* Padded scratch for recurrent contribution */
+
+    void forward(const float* x);
+};
+
+template <typename Matrix>
+void RecurrentLayer<Matrix>::forward(const float* x)
+{
+    const int H = hidden_size;
+    float* g = gates.data();
+    float* r = rgates.data();
+
+    std::copy(bias.begin(), bias.end(), g);
+    for (int i = 0; i < in_size; i++) {
+        const float xi = x[i];
+        const float* w = kernel.data() + i * gates_size;
+        for (int k = 0; k < gates_size; k++)
+            g[k] += w[k] * xi;
+    }
+
+    if (lstm) {
+        recurrent.multiply(h.data(), g);
+        for (int k = 0; k < H; k++) {
+            const float ig = sigmoid(g[k]);
+            const float fg = sigmoid(g[H + k]);
+            const float cg = tanhf(g[2 * H + k]);
+            const float og = sigmoid(g[3 * H + k]);
+            c[k] = fg * c[k] + ig * cg;
+            h[k] = og * tanhf(c[k]);
+        }
+    }
+    else {
+        std::copy(recurrent_bias.begin(), recurrent_bias.end(), r);
+        recurrent.multiply(h.data(), r);
+        for (int k = 0; k < H; k++) {
+            const float zg = sigmoid(g[k] + r[k]);
+            const float rg = sigmoid(g[H + k] + r[H + k]);
+            const float hg = tanhf(g[2 * H + k] + rg * r[2 * H + k]);
+            h[k] = (1.0f - zg) * hg + zg * h[k];
+        }
+    }
+}
+
+struct DenseLayer {
+    explicit DenseLayer(ModelArena& arena) : weights(arena), bias(arena), y(arena) {}
+
+    int in_size;
+    int out_size;
+    bool use_tanh;
+    EngineVector<float> weights; /* in_size x out_size */
+    EngineVector<float> bias;
+    EngineVector<float> y;
+
+    void forward(const float* x);
+};
+
+void DenseLayer::forward(const float* x)
+{
+    std::copy(bias.begin(), bias.end(), y.begin());
+    for (int i = 0; i < in_size; i++) {
+        const float xi = x[i];
+        const float* w = weights.data() + i * out_size;
+        for (int o = 0; o < out_size; o++)
+            y[o] += w[o] * xi;
+    }
+    if (use_tanh) {
+        for (float& v : y)
+            v = tanhf(v);
+    }
+}
+
+template <typename Matrix>
+class alignas(CACHE_LINE_SIZE) RecurrentEngine : public ModelEngine
+{
+public:
+    explicit RecurrentEngine(ModelArena& arena) : recurrent_layers(arena), dense_layers(arena) {}
+
+    void process(DynamicModel* model, float* out, uint32_t n_samples) override;
+    void saveState() override;
+    void restoreState() override;
+    void setInputKernel(const std::vector<std::vector<float>>& kernel) override;
+    void setOutputLayer(const std::vector<std::vector<float>>& weights, const std::vector<float>& bias) override;
+    void getMemoryRegions(MemoryRegions& regions) const override;
+    void serialize(ModelImage& image, const nlohmann::json& model_json) const override;
+    std::string getInfo() const override { return info; }
+
+    float forward(const float* x);
+
+    EngineVector<RecurrentLayer<Matrix>> recurrent_layers; /* Recurrent layers come first */
+    EngineVector<DenseLayer> dense_layers;
+    std::string info;
+
+private:
+#if AIDADSP_FOLD_PARAMS
+    uint32_t foldParams(DynamicModel* model, uint32_t n_samples);
+#endif
+};
+
+template <typename Matrix>
+float RecurrentEngine<Matrix>::forward(const float* x)
+{
+    for (RecurrentLayer<Matrix>& layer : recurrent_layers) {
+        layer.forward(x);
+        x = layer.h.data();
+    }
+    for (DenseLayer& layer : dense_layers) {
+        layer.forward(x);
+        x = layer.y.data();
+    }
+    return x[0];
+}
+
+#if AIDADSP_FOLD_PARAMS
+/* Same as foldParams in model-engine.cpp, on the first recurrent layer input bias */
+template <typename Matrix>
+uint32_t RecurrentEngine<Matrix>::foldParams(DynamicModel* model, uint32_t n_samples)
+{
+    if (model->n_params == 0)
+        return n_samples;
+
+    LinearValueSmoother& param1Coeff = model->param1Coeff;
+    LinearValueSmoother& param2Coeff = model->param2Coeff;
+
+    if (param1Coeff.getCurrentValue() != param1Coeff.getTargetValue() ||
+        param2Coeff.getCurrentValue() != param2Coeff.getTargetValue()) {
+        n_samples = std::min(n_samples, static_cast<uint32_t>(PARAM_FOLD_BLOCK));
+        for (uint32_t i=0; i<n_samples; ++i) {
+            param1Coeff.next();
+            param2Coeff.next();
+        }
+    }
+
+    const float param1 = param1Coeff.getCurrentValue();
+    const float param2 = param2Coeff.getCurrentValue();
+    if (param1 != model->foldedParam1 || param2 != model->foldedParam2) {
+        model->foldedParam1 = param1;
+        model->foldedParam2 = param2;
+        EngineVector<float>& bias = recurrent_layers.front().bias;
+        for (size_t k=0; k<model->paramBias.size(); ++k) {
+            bias[k] = model->paramBias[k] + param1 * model->paramWeights[0][k] + param2 * model->paramWeights[1][k];
+        }
+    }
+
+    return n_samples;
+}
+#endif
+
+template <typename Matrix>
+void RecurrentEngine<Matrix>::process(DynamicModel* model, float* out, uint32_t n_samples)
+{
+    const bool input_skip = model->input_skip;
+    const float skip_gain = model->skip_gain;
+    const int in_size = recurrent_layers.front().in_size;
+    float in[AIDADSP_PARAMS + 1] = {};
+
+    uint32_t start = 0;
+    while (start < n_samples) {
+#if AIDADSP_FOLD_PARAMS
+        const uint32_t end = start + foldParams(model, n_samples - start);
+#else
+        const uint32_t end = n_samples;
+#endif
+        for (uint32_t i=start; i<end; ++i) {
+            in[0] = out[i];
+#if AIDADSP_CONDITIONED_MODELS
+            if (in_size > 1)
+                in[1] = model->param1Coeff.next();
+            if (in_size > 2)
+                in[2] = model->param2Coeff.next();
+#endif
+            const float y = forward(in);
+            out[i] = input_skip ? y + out[i] * skip_gain : y;
+        }
+        start = end;
+    }
+}
+
+template <typename Matrix>
+void RecurrentEngine<Matrix>::saveState()
+{
+    for (RecurrentLayer<Matrix>& layer : recurrent_layers) {
+        std::copy(layer.h.begin(), layer.h.end(), layer.warm_h.begin());
+        std::copy(layer.c.begin(), layer.c.end(), layer.warm_c.begin());
+    }
+}
+
+template <typename Matrix>
+void RecurrentEngine<Matrix>::restoreState()
+{
+    for (RecurrentLayer<Matrix>& layer : recurrent_layers) {
+        std::copy(layer.warm_h.begin(), layer.warm_h.end(), layer.h.begin());
+        std::copy(layer.warm_c.begin(), layer.warm_c.end(), layer.c.begin());
+    }
+}
+
+template <typename Matrix>
+void RecurrentEngine<Matrix>::getMemoryRegions(MemoryRegions& regions) const
+{
+    regions.push_back({ this, sizeof(*this) });
+    addMemoryRegion(regions, recurrent_layers);
+    addMemoryRegion(regions, dense_layers);
+    for (const RecurrentLayer<Matrix>& layer : recurrent_layers) {
+        layer.recurrent.getMemoryRegions(regions);
+        for (const EngineVector<float>* buffer : { &layer.kernel, &layer.bias, &layer.recurrent_bias, &layer.h, &layer.c,
+            &layer.warm_h, &layer.warm_c, &layer.gates, &layer.rgates }) {
+            addMemoryRegion(regions, *buffer);
+        }
+    }
+    for (const DenseLayer& layer : dense_layers) {
+        addMemoryRegion(regions, layer.weights);
+        addMemoryRegion(regions, layer.bias);
+        addMemoryRegion(regions, layer.y);
+    }
+}
+
+template <typename Matrix>
+void RecurrentEngine<Matrix>::setInputKernel(const std::vector<std::vector<float>>& kernel)
+{
+    RecurrentLayer<Matrix>& layer = recurrent_layers.front();
+    for (int i = 0; i < layer.in_size; i++)
+        std::copy(kernel[i].begin(), kernel[i].end(), layer.kernel.begin() + i * layer.gates_size);
+}
+
+template <typename Matrix>
+void RecurrentEngine<Matrix>::setOutputLayer(const std::vector<std::vector<float>>& weights, const std::vector<float>& bias)
+{
+    DenseLayer& layer = dense_layers.back();
+    for (int o = 0; o < layer.out_size; o++)
+        for (int i = 0; i < layer.in_size; i++)
+            layer.weights[i * layer.out_size + o] = weights[o][i];
+    std::copy(bias.begin(), bias.end(), layer.bias.begin());
+}
+
+/* Layers with their folded weights and warm state, the rest is scratch */
+template <typename Matrix>
+void RecurrentEngine<Matrix>::serialize(ModelImage& image, const nlohmann::json&) const
+{
+    image.put<uint64_t>(recurrent_layers.size());
+    for (const RecurrentLayer<Matrix>& layer : recurrent_layers) {
+        image.put(layer.lstm);
+        image.put(layer.in_size);
+        image.put(layer.hidden_size);
+        image.putVector(layer.kernel);
+        layer.recurrent.serialize(image);
+        image.putVector(layer.bias);
+        image.putVector(layer.recurrent_bias);
+        image.putVector(layer.warm_h);
+        image.putVector(layer.warm_c);
+    }
+    image.put<uint64_t>(dense_layers.size());
+    for (const DenseLayer& layer : dense_layers) {
+        image.put(layer.in_size);
+        image.put(layer.out_size);
+        image.put(layer.use_tanh);
+        image.putVector(layer.weights);
+        image.putVector(layer.bias);
+    }
+    image.putString(info);
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Builds the engine layers from the model file, assign_recurrent(layer.recurrent, json_layer, index)
+ * fills in the recurrent kernel of the index-th recurrent layer.
+ */
+template <typename Matrix, typename AssignRecurrent>
+EnginePtr<RecurrentEngine<Matrix>> parseEngine(const nlohmann::json& model_json, ModelArena& arena, AssignRecurrent assign_recurrent)
+{
+    EnginePtr<RecurrentEngine<Matrix>> engine(arena.construct<RecurrentEngine<Matrix>>(arena));
+
+    int in_size = model_json.at("in_shape").back().get<int>();
+    if (in_size > AIDADSP_PARAMS + 1)
+        throw std::invalid_argument("Value for input_size not supported");
+    engine->recurrent_layers.reserve(model_json.at("layers").size());
+    engine->dense_layers.reserve(model_json.at("layers").size());
+
+    for (const nlohmann::json& json_layer : model_json.at("layers")) {
+        const std::string type = json_layer.at("type").get<std::string>();
+        const std::string activation = json_layer.contains("activation") ? json_layer.at("activation").get<std::string>() : "";
+        const int size = json_layer.at("shape").back().get<int>();
+        const nlohmann::json& json_weights = json_layer.at("weights");
+
+        if (type == "lstm" || type == "gru") {
+            if (!engine->dense_layers.empty())
+                throw std::invalid_argument("Recurrent layers after dense ones are not supported");
+            RecurrentLayer<Matrix> layer(arena);
+            layer.lstm = type == "lstm";
+            layer.in_size = in_size;
+            layer.hidden_size = size;
+            layer.gates_size = (layer.lstm ? 4 : 3) * size;
+            assignFlat(layer.kernel, json_weights.at(0).get<std::vector<std::vector<float>>>());
+            assign_recurrent(layer.recurrent, json_layer, engine->recurrent_layers.size());
+            if (layer.lstm) {
+                assignFlat(layer.bias, { json_weights.at(2).get<std::vector<float>>() }, paddedSize(layer.gates_size));
+            }
+            else {
+                const std::vector<std::vector<float>> bias = json_weights.at(2);
+                assignFlat(layer.bias, { bias.at(0) }, paddedSize(layer.gates_size));
+                assignFlat(layer.recurrent_bias, { bias.at(1) }, paddedSize(layer.gates_size));
+            }
+            if (static_cast<int>(layer.kernel.size()) != in_size * layer.gates_size
+                || layer.recurrent.rows != size || layer.recurrent.cols != layer.gates_size)
+                throw std::invalid_argument("Recurrent layer shape does not match weights");
+            layer.h.assign(size, 0.0f);
+            layer.c.assign(layer.lstm ? size : 0, 0.0f);
+            layer.warm_h.assign(layer.h.size(), 0.0f);
+            layer.warm_c.assign(layer.c.size(), 0.0f);
+            layer.gates.assign(paddedSize(layer.gates_size), 0.0f);
+            layer.rgates.assign(paddedSize(layer.gates_size), 0.0f);
+            engine->recurrent_layers.push_back(std::move(layer));
+        }
+        else if (type == "dense") {
+            if (!activation.empty() && activation != "linear" && activation != "tanh")
+                throw std::invalid_argument("Activation " + activation + " not supported on dense layers");
+            DenseLayer layer(arena);
+            layer.in_size = in_size;
+            layer.out_size = size;
+            layer.use_tanh = activation == "tanh";
+            assignFlat(layer.weights, json_weights.at(0).get<std::vector<std::vector<float>>>());
+            assignFlat(layer.bias, { json_weights.at(1).get<std::vector<float>>() });
+            if (static_cast<int>(layer.weights.size()) != in_size * size || static_cast<int>(layer.bias.size()) != size)
+                throw std::invalid_argument("Dense layer shape does not match weights");
+            layer.y.assign(size, 0.0f);
+            engine->dense_layers.push_back(std::move(layer));
+        }
+        else {
+            throw std::invalid_argument("Layer type " + type + " not supported in recurrent models");
+        }
+        in_size = size;
+    }
+
+    if (engine->recurrent_layers.empty() || engine->dense_layers.empty() || in_size != 1)
+        throw std::invalid_argument("Unable to identify a known model architecture!");
+
+    return engine;
+}
+
+/* Built back as serialized, from its warm state, see RecurrentEngine::serialize */
+template <typename Matrix>
+ModelEngine* restoreEngine(ModelImageReader& image, ModelArena& arena)
+{
+    EnginePtr<RecurrentEngine<Matrix>> engine(arena.construct<RecurrentEngine<Matrix>>(arena));
+
+    const uint64_t n_recurrent = image.get<uint64_t>();
+    engine->recurrent_layers.reserve(n_recurrent);
+    for (uint64_t l = 0; l < n_recurrent; l++) {
+        RecurrentLayer<Matrix> layer(arena);
+        layer.lstm = image.get<bool>();
+        layer.in_size = image.get<int>();
+        layer.hidden_size = image.get<int>();
+        layer.gates_size = (layer.lstm ? 4 : 3) * layer.hidden_size;
+        image.getVector(layer.kernel);
+        layer.recurrent.restore(image);
+        image.getVector(layer.bias);
+        image.getVector(layer.recurrent_bias);
+        image.getVector(layer.warm_h);
+        image.getVector(layer.warm_c);
+        if (static_cast<int>(layer.kernel.size()) != layer.in_size * layer.gates_size
+            || layer.recurrent.rows != layer.hidden_size || layer.recurrent.cols != layer.gates_size
+            || static_cast<int>(layer.bias.size()) != paddedSize(layer.gates_size)
+            || static_cast<int>(layer.recurrent_bias.size()) != (layer.lstm ? 0 : paddedSize(layer.gates_size))
+            || static_cast<int>(layer.warm_h.size()) != layer.hidden_size
+            || static_cast<int>(layer.warm_c.size()) != (layer.lstm ? layer.hidden_size : 0))
+            throw std::runtime_error("Bad recurrent layer image");
+        layer.h.assign(layer.warm_h.begin(), layer.warm_h.end());
+        layer.c.assign(layer.warm_c.begin(), layer.warm_c.end());
+        layer.gates.assign(paddedSize(layer.gates_size), 0.0f);
+        layer.rgates.assign(paddedSize(layer.gates_size), 0.0f);
+        engine->recurrent_layers.push_back(std::move(layer));
+    }
+
+    const uint64_t n_dense = image.get<uint64_t>();
+    engine->dense_layers.reserve(n_dense);
+    for (uint64_t l = 0; l < n_dense; l++) {
+        DenseLayer layer(arena);
+        layer.in_size = image.get<int>();
+        layer.out_size = image.get<int>();
+        layer.use_tanh = image.get<bool>();
+        image.getVector(layer.weights);
+        image.getVector(layer.bias);
+        if (static_cast<int>(layer.weights.size()) != layer.in_size * layer.out_size || static_cast<int>(layer.bias.size()) != layer.out_size)
+            throw std::runtime_error("Bad dense layer image");
+        layer.y.assign(layer.out_size, 0.0f);
+        engine->dense_layers.push_back(std::move(layer));
+    }
+    if (engine->recurrent_layers.empty() || engine->dense_layers.empty())
+        throw std::runtime_error("Bad recurrent model image");
+    engine->info = image.getString();
+
+    return engine.release();
+}
+
+ModelEngine* createSparseEngine(const nlohmann::json& model_json, ModelArena& arena)
+{
+    return parseEngine<SparseMatrix>(model_json, arena,
+        [](SparseMatrix& recurrent, const nlohmann::json& json_layer, size_t) {
+            recurrent.assign(recurrentKernel(json_layer));
+        }).release();
+}
+
+/**
+ * Left singular vectors of matrix, by decreasing singular value, as eigenvectors of matrix times
+ * its transpose. These are found with cyclic Jacobi rotations, fine for hidden sizes at load time.
+ */
+std::vector<std::vector<double>> leftSingularVectors(const std::vector<std::vector<float>>& matrix)
+{
+    const int n = matrix.size();
+    std::vector<std::vector<double>> m(n, std::vector<double>(n, 0.0));
+    std::vector<std::vector<double>> v(n, std::vector<double>(n, 0.0));
+    for (int i = 0; i < n; i++) {
+        v[i][i] = 1.0;
+        for (int j = 0; j < n; j++)
+            for (size_t k = 0; k < matrix[i].size(); k++)
+                m[i][j] += static_cast<double>(matrix[i][k]) * matrix[j][k];
+    }
+
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = 0.0;
+        double diag = 0.0;
+        for (int p = 0; p < n; p++) {
+            diag += m[p][p] * m[p][p];
+            for (int q = p + 1; q < n; q++)
+                off += m[p][q] * m[p][q];
+        }
+        if (off <= 1.0e-24 * diag)
+            break;
+
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                if (m[p][q] == 0.0)
+                    continue;
+                const double theta = (m[q][q] - m[p][p]) / (2.0 * m[p][q]);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (int k = 0; k < n; k++) {
+                    const double mkp = m[k][p];
+                    const double mkq = m[k][q];
+                    m[k][p] = c * mkp - s * mkq;
+                    m[k][q] = s * mkp + c * mkq;
+                }
+                for (int k = 0; k < n; k++) {
+                    const double mpk = m[p][k];
+                    const double mqk = m[q][k];
+                    m[p][k] = c * mpk - s * mqk;
+                    m[q][k] = s * mpk + c * mqk;
+                }
+                for (int k = 0; k < n; k++) {
+                    const double vkp = v[k][p];
+                    const double vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&m](int a, int b) { return m[a][a] > m[b][b]; });
+
+    std::vector<std::vector<double>> vectors(n, std::vector<double>(n));
+    for (int k = 0; k < n; k++)
+        for (int i = 0; i < n; i++)
+            vectors[k][i] = v[i][order[k]];
+    return vectors;
+}
+
+/* Best rank approximation of matrix on the given left singular vectors */
+void assignLowRank(LowRankMatrix& recurrent, const std::vector<std::vector<float>>& matrix, const std::vector<std::vector<double>>& basis, int rank)
+{
+    const int rows = matrix.size();
+    const int cols = rows > 0 ? matrix[0].size() : 0;
+    std::vector<std::vector<float>> left(rows, std::vector<float>(rank));
+    std::vector<std::vector<float>> right(rank, std::vector<float>(cols, 0.0f));
+    for (int k = 0; k < rank; k++) {
+        std::vector<double> projection(cols, 0.0);
+        for (int i = 0; i < rows; i++) {
+            left[i][k] = basis[k][i];
+            for (int j = 0; j < cols; j++)
+                projection[j] += basis[k][i] * matrix[i][j];
+        }
+        std::copy(projection.begin(), projection.end(), right[k].begin());
+    }
+    recurrent.assign(left, right);
+}
+
+/* Error to signal ratio of the engine against output_batch, run on a fresh engine */
+template <typename Engine>
+double batchEsr(Engine& engine, const nlohmann::json& model_json)
+{
+    const std::vector<float> input_batch = model_json.at("input_batch");
+    const std::vector<float> output_batch = model_json.at("output_batch");
+    const bool input_skip = model_json.contains("in_skip") && model_json.at("in_skip").is_number() && model_json.at("in_skip").get<int>() == 1;
+    double error = 0.0;
+    double signal = 0.0;
+    for (size_t i = 0; i < input_batch.size() && i < output_batch.size(); i++) {
+        const float x[AIDADSP_PARAMS + 1] = { input_batch[i] };
+        const float y = engine.forward(x) + (input_skip ? input_batch[i] : 0.0f);
+        error += (y - output_batch[i]) * (y - output_batch[i]);
+        signal += output_batch[i] * output_batch[i];
+    }
+    return signal > 0.0 ? error / signal : error;
+}
+
+/**
+ * Uses the factors found in the model file, otherwise tries increasing ranks until the error on
+ * input_batch is within budget of the full rank one, while the factors are cheaper than the kernel.
+ * Ranks are tried on engines of their own, only the one kept is built in the model arena.
+ */
+ModelEngine* createLowRankEngine(const nlohmann::json& model_json, ModelArena& arena)
+{
+    const nlohmann::json& json_layers = model_json.at("layers");
+
+    if (json_layers.at(0).contains("recurrent_factors")) {
+        EnginePtr<RecurrentEngine<LowRankMatrix>> engine = parseEngine<LowRankMatrix>(model_json, arena,
+            [](LowRankMatrix& recurrent, const nlohmann::json& json_layer, size_t) {
+                const nlohmann::json& factors = json_layer.at("recurrent_factors");
+                recurrent.assign(factors.at(0), factors.at(1));
+            });
+        engine->info = "rank " + std::to_string(engine->recurrent_layers.front().recurrent.rank) + " from model file";
+        return engine.release();
+    }
+
+    std::vector<std::vector<std::vector<float>>> kernels;
+    std::vector<std::vector<std::vector<double>>> bases;
+    for (const nlohmann::json& json_layer : json_layers) {
+        const std::string type = json_layer.at("type").get<std::string>();
+        if (type == "lstm" || type == "gru") {
+            kernels.push_back(recurrentKernel(json_layer));
+            bases.push_back(leftSingularVectors(kernels.back()));
+        }
+    }
+    if (kernels.empty())
+        throw std::invalid_argument("Unable to identify a known model architecture!");
+
+    const auto engineWithRank = [&](int rank, ModelArena& engine_arena) {
+        return parseEngine<LowRankMatrix>(model_json, engine_arena,
+            [&](LowRankMatrix& recurrent, const nlohmann::json&, size_t index) {
+                const int rows = kernels[index].size();
+                assignLowRank(recurrent, kernels[index], bases[index], std::min(rank, rows));
+            });
+    };
+
+    const int rows = kernels.front().size();
+    const int cols = kernels.front()[0].size();
+    double full_esr;
+    {
+        ModelArena full_arena;
+        full_esr = batchEsr(*engineWithRank(rows, full_arena), model_json);
+    }
+
+    for (int rank = LOWRANK_RANK_STEP; rank * (rows + paddedSize(cols)) < rows * cols; rank += LOWRANK_RANK_STEP) {
+        double esr;
+        {
+            ModelArena rank_arena;
+            esr = batchEsr(*engineWithRank(rank, rank_arena), model_json);
+        }
+        if (esr <= full_esr + LOWRANK_ESR_BUDGET) {
+            EnginePtr<RecurrentEngine<LowRankMatrix>> engine = engineWithRank(rank, arena);
+            char info[128];
+            snprintf(info, sizeof(info), "rank %d of %d, ESR %.6f vs %.6f at full rank", rank, rows, esr, full_esr);
+            engine->info = info;
+            return engine.release();
+        }
+    }
+
+    throw std::invalid_argument("No cheaper rank within the error budget");
+}
+
+} // namespace
+
+/**
+ * Sparse kernels only pay off with many empty blocks, models with a mask are always given a try.
+ */
+bool isSparseModel(const nlohmann::json& model_json)
+{
+    size_t blocks = 0;
+    size_t empty_blocks = 0;
+    for (const nlohmann::json& json_layer : model_json.at("layers")) {
+        const std::string type = json_layer.at("type").get<std::string>();
+        if (type != "lstm" && type != "gru")
+            continue;
+        if (json_layer.contains("mask"))
+            return true;
+        ModelArena arena;
+        SparseMatrix recurrent(arena);
+        recurrent.assign(recurrentKernel(json_layer));
+        blocks += recurrent.rows * (paddedSize(recurrent.cols) / SPARSE_BLOCK);
+        empty_blocks += recurrent.rows * (paddedSize(recurrent.cols) / SPARSE_BLOCK) - recurrent.block_col.size();
+    }
+    return blocks > 0 && empty_blocks >= SPARSE_MIN_EMPTY_BLOCKS * blocks;
+}
+
+/**
+ * Factors from the model file are always given a try, otherwise every recurrent layer must be big
+ * enough and the model must come with a snapshot input_batch to measure the error on.
+ */
+bool isLowRankModel(const nlohmann::json& model_json)
+{
+    bool recurrent = false;
+    for (const nlohmann::json& json_layer : model_json.at("layers")) {
+        const std::string type = json_layer.at("type").get<std::string>();
+        if (type != "lstm" && type != "gru")
+            continue;
+        if (json_layer.contains("recurrent_factors"))
+            return true;
+        if (json_layer.at("shape").back().get<int>() < LOWRANK_MIN_HIDDEN_SIZE)
+            return false;
+        recurrent = true;
+    }
+    if (!recurrent || !model_json.contains("input_batch") || !model_json.contains("output_batch"))
+        return false;
+    const nlohmann::json& input_batch = model_json.at("input_batch");
+    return input_batch.is_array() && !input_batch.empty() && input_batch[0].is_number()
+        && model_json.at("output_batch").is_array();
+}
+
+const ModelBackend model_backend_sparse = { AIDADSP_BACKEND_SPARSE, "sparse", createSparseEngine, restoreEngine<SparseMatrix>, nullptr };
+const ModelBackend model_backend_lowrank = { AIDADSP_BACKEND_LOWRANK, "lowrank", createLowRankEngine, restoreEngine<LowRankMatrix>, nullptr };
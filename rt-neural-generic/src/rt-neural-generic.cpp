@@ -30,6 +30,25 @@ const LV2_Descriptor* lv2_descriptor(uint32_t index)
 
 /**********************************************************************************************************************************************************/
 
+/* Backends compiled in, when two of them cost the same the first one wins */
+static const ModelBackend* const model_backends[] = {
+#if AIDADSP_WITH_XSIMD
+    &model_backend_xsimd,
+#endif
+#if AIDADSP_WITH_EIGEN
+    &model_backend_eigen,
+#endif
+#if AIDADSP_WITH_STL
+    &model_backend_stl,
+#endif
+    nullptr
+};
+
+/* Engines beyond RTNeural backends, tried on the models they apply to */
+#define MAX_MODEL_BACKENDS 8
+
+/**********************************************************************************************************************************************************/
+
 // Apply a gain ramp to a buffer
 static void applyGainRamp(ExponentialValueSmoother& smoother, float *out, const float *in, uint32_t n_samples) {
     for(uint32_t i=0; i<n_samples; i++) {
@@ -47,6 +66,24 @@ void RtNeuralGeneric::applyBiquadFilter(float *out, const float *in, Biquad *fil
 
 /**********************************************************************************************************************************************************/
 
+/**
+ * Runs a tone band in place when active. A skipped band still holds the state of the audio it last
+ * ran on, that state is cleared before the band runs again so that it does not click back in.
+ */
+void RtNeuralGeneric::applyToneBand(float *out, Biquad *filter, uint8_t band, bool active, uint8_t& skipped, uint32_t n_samples) {
+    if(!active) {
+        skipped |= band;
+        return;
+    }
+    if(skipped & band) {
+        filter->reset();
+        skipped &= ~band;
+    }
+    applyBiquadFilter(out, out, filter, n_samples);
+}
+
+/**********************************************************************************************************************************************************/
+
 void RtNeuralGeneric::applyToneControls(float *out, const float *in, LV2_Handle instance, uint32_t n_samples)
 {
     RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
@@ -126,117 +163,335 @@ void RtNeuralGeneric::applyToneControls(float *out, const float *in, LV2_Handle
         self->presence->setBiquad(bq_type_highshelf, PRESENCE_FREQ / self->samplerate, PRESENCE_Q, presence_boost_db);
     }
 
-    /* Run biquad cascade filters */
-    if(mid_type == BANDPASS) {
-        applyBiquadFilter(out, in, self->mid, n_samples);
-    }
-    else {
-        applyBiquadFilter(out, in, self->depth, n_samples);
-        applyBiquadFilter(out, out, self->bass, n_samples);
-        applyBiquadFilter(out, out, self->mid, n_samples);
-        applyBiquadFilter(out, out, self->treble, n_samples);
-        applyBiquadFilter(out, out, self->presence, n_samples);
+    /* Run biquad cascade filters, a flat band passes its input through so it can be skipped */
+    const bool bandpass = mid_type == BANDPASS;
+    const bool skip_flat = self->governor_tier >= GOVERNOR_TIER_EQ;
+    if(out != in) {
+        std::memcpy(out, in, sizeof(float)*n_samples);
     }
+    applyToneBand(out, self->depth, TONE_BAND_DEPTH, !bandpass && (!skip_flat || depth_boost_db != 0.0f), self->tone_skipped, n_samples);
+    applyToneBand(out, self->bass, TONE_BAND_BASS, !bandpass && (!skip_flat || bass_boost_db != 0.0f), self->tone_skipped, n_samples);
+    applyToneBand(out, self->mid, TONE_BAND_MID, bandpass || !skip_flat || mid_boost_db != 0.0f, self->tone_skipped, n_samples);
+    applyToneBand(out, self->treble, TONE_BAND_TREBLE, !bandpass && (!skip_flat || treble_boost_db != 0.0f), self->tone_skipped, n_samples);
+    applyToneBand(out, self->presence, TONE_BAND_PRESENCE, !bandpass && (!skip_flat || presence_boost_db != 0.0f), self->tone_skipped, n_samples);
 }
 
 /**********************************************************************************************************************************************************/
 
 /**
- * This function carries model calculations for snapshot models, models with one parameter and
- * models with two parameters.
+ * This function runs the model in place on the engine it has been built with.
  */
 void RtNeuralGeneric::applyModel(DynamicModel* model, float* out, uint32_t n_samples)
 {
-    const bool input_skip = model->input_skip;
-    const float input_gain = model->input_gain;
-    const float output_gain = model->output_gain;
+    model->engine->process(model, out, n_samples);
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Snapshot of the model state, to be taken in the worker once the model has converged on silence.
+ */
+void DynamicModel::saveState()
+{
+    engine->saveState();
+}
+
+/**
+ * Bring the model back to its saved state, this is realtime safe. The snapshot carries the bias folded
+ * when it was taken, so params get folded again on next run.
+ */
+void DynamicModel::restoreState()
+{
+    engine->restoreState();
+#if AIDADSP_FOLD_PARAMS
+    foldedParam1 = NAN;
+    foldedParam2 = NAN;
+#endif
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * This function runs the model behind a silence detector. Once the input peak stays below threshold
+ * for the hold time, the last block is faded to its final value and the model is idled, holding that
+ * value: after the hold time the model has settled on silence, so it is its steady-state output.
+ * When signal returns the model is restored to its warm state and runs again.
+ */
+void RtNeuralGeneric::applyModelOrIdle(float *out, DynamicModel *model, LV2_Handle instance, uint32_t n_samples)
+{
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
+#if AIDADSP_SILENCE_CONTROLS
+    const float threshold = DB_CO(*self->silence_thr_db);
+    const uint32_t hold_samples = static_cast<uint32_t>(*self->silence_hold_ms * 0.001f * self->samplerate);
+#else
+    const float threshold = DB_CO(SILENCE_THR_DB);
+    const uint32_t hold_samples = static_cast<uint32_t>(SILENCE_HOLD_MS * 0.001f * self->samplerate);
+#endif
+
+    float peak = 0.0f;
+    for(uint32_t i=0; i<n_samples; i++) {
+        peak = std::max(peak, std::abs(out[i]));
+    }
+
+    if (peak >= threshold) {
+        self->silence_samples = 0;
+        if (self->model_idle) {
+            self->model_idle = false;
+            model->restoreState();
+        }
+        applyModel(model, out, n_samples);
+        return;
+    }
+
+    if (self->model_idle) {
+        std::fill(out, out + n_samples, self->idle_output);
+        return;
+    }
+
+    applyModel(model, out, n_samples);
+    self->silence_samples = std::min(self->silence_samples + n_samples, hold_samples);
+    if (self->silence_samples >= hold_samples) {
+        /* Tail fade towards the value held while idle */
+        const float last = out[n_samples - 1];
+        const float step = 1.0f / n_samples;
+        for(uint32_t i=0; i<n_samples; i++) {
+            out[i] += (last - out[i]) * (i + 1) * step;
+        }
+        self->idle_output = last;
+        self->model_idle = true;
+    }
+}
+
+/**
+ * Start a model from its warm state with params in place, after it has been switched to.
+ */
+void RtNeuralGeneric::restartModel(DynamicModel *model, LV2_Handle instance)
+{
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
+
+    model->restoreState();
 #if AIDADSP_CONDITIONED_MODELS
-    LinearValueSmoother& param1Coeff = model->param1Coeff;
-    LinearValueSmoother& param2Coeff = model->param2Coeff;
+    model->paramFirstRun = true;
 #endif
+    self->silence_samples = 0;
+    self->model_idle = false;
+}
+
+/**
+ * Model stage on the audio thread, restarting the model first when it has been switched.
+ */
+void RtNeuralGeneric::applyModelInline(float *out, DynamicModel *model, float param1, float param2, LV2_Handle instance, uint32_t n_samples)
+{
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
 
-    std::visit (
-        [input_skip, &out, n_samples, input_gain, output_gain
+    if (self->model_restart) {
+        self->model_restart = false;
+        restartModel(model, instance);
+    }
 #if AIDADSP_CONDITIONED_MODELS
-        , &param1Coeff, &param2Coeff
+    setModelParams(model, param1, param2);
 #endif
-        ] (auto&& custom_model)
-        {
-            using ModelType = std::decay_t<decltype (custom_model)>;
-            if constexpr (ModelType::input_size == 1)
-            {
-                if (input_skip)
-                {
-                    for (uint32_t i=0; i<n_samples; ++i) {
-                        out[i] *= input_gain;
-                        out[i] += custom_model.forward (out + i);
-                        out[i] *= output_gain;
-                    }
-                }
-                else
-                {
-                    for (uint32_t i=0; i<n_samples; ++i) {
-                        out[i] *= input_gain;
-                        out[i] = custom_model.forward (out + i);
-                        out[i] *= output_gain;
-                    }
-                }
-            }
+    applyModelOrIdle(out, model, instance, n_samples);
+}
+
 #if AIDADSP_CONDITIONED_MODELS
-            else if constexpr (ModelType::input_size == 2)
-            {
-                float inArray1 alignas(RTNEURAL_DEFAULT_ALIGNMENT)[2] = { 0.0, 0.0 };
-                if (input_skip)
-                {
-                    for (uint32_t i=0; i<n_samples; ++i) {
-                        out[i] *= input_gain;
-                        inArray1[0] = out[i];
-                        inArray1[1] = param1Coeff.next();
-                        out[i] += custom_model.forward (inArray1);
-                        out[i] *= output_gain;
-                    }
-                }
-                else
-                {
-                    for (uint32_t i=0; i<n_samples; ++i) {
-                        out[i] *= input_gain;
-                        inArray1[0] = out[i];
-                        inArray1[1] = param1Coeff.next();
-                        out[i] = custom_model.forward (inArray1);
-                        out[i] *= output_gain;
-                    }
-                }
+void RtNeuralGeneric::setModelParams(DynamicModel *model, float param1, float param2)
+{
+    model->param1Coeff.setTargetValue(param1);
+    model->param2Coeff.setTargetValue(param2);
+    if (model->paramFirstRun) {
+        model->paramFirstRun = false;
+        model->param1Coeff.clearToTargetValue();
+        model->param2Coeff.clearToTargetValue();
+    }
+}
+#endif
+
+#ifdef AIDADSP_CHANNELS
+/**
+ * Crossfade from the previous channel model output, CHANNEL_FADE_SAMPLES long over as many runs
+ * as needed. The previous model is dropped once faded out.
+ */
+void RtNeuralGeneric::applyChannelFade(float *out, const float *from, LV2_Handle instance, uint32_t n_samples)
+{
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
+    const float step = 1.0f / CHANNEL_FADE_SAMPLES;
+
+    for(uint32_t i=0; i<n_samples; i++) {
+        const float gain = (self->channel_fade_pos + i + 1) * step;
+        out[i] = from[i] + (out[i] - from[i]) * gain;
+    }
+    self->channel_fade_pos += n_samples;
+    if (self->channel_fade_pos >= CHANNEL_FADE_SAMPLES) {
+        self->channel_fade_model = nullptr;
+    }
+}
+#endif
+
+/**********************************************************************************************************************************************************/
+
+#if AIDADSP_PIPELINE
+/**
+ * Pipelined model stage: the block goes to the helper thread and the one submitted on previous run
+ * comes back in its place, one period late. The helper owns the model and the silence detector
+ * while a block is in flight. If it is late on its block the deadline is missed: the mode is turned
+ * off and the last block delivered is crossfaded to the dry input, which then passes until the
+ * helper is done. The model runs inline from there, crossfaded in from the dry input, or from the
+ * last block when the mode is turned off on time. Returns false when the model stage is left to the
+ * caller to run inline.
+ */
+bool RtNeuralGeneric::applyModelPipelined(float *out, DynamicModel *model, float param1, float param2, LV2_Handle instance, uint32_t n_samples, bool pipelined)
+{
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
+    PipelineBlock* result = nullptr;
+
+    if (self->pipeline.pending()) {
+        result = self->pipeline.collect();
+        if (result == nullptr) {
+            if (pipelined) {
+                self->pipeline_failed = true;
+                self->log_ring.log(kRtLogPipelineMissed);
             }
-            else if constexpr (ModelType::input_size == 3)
-            {
-                float inArray2 alignas(RTNEURAL_DEFAULT_ALIGNMENT)[3] = { 0.0, 0.0, 0.0 };
-                if (input_skip)
-                {
-                    for (uint32_t i=0; i<n_samples; ++i) {
-                        out[i] *= input_gain;
-                        inArray2[0] = out[i];
-                        inArray2[1] = param1Coeff.next();
-                        inArray2[2] = param2Coeff.next();
-                        out[i] += custom_model.forward (inArray2);
-                        out[i] *= output_gain;
-                    }
-                }
-                else
-                {
-                    for (uint32_t i=0; i<n_samples; ++i) {
-                        out[i] *= input_gain;
-                        inArray2[0] = out[i];
-                        inArray2[1] = param1Coeff.next();
-                        inArray2[2] = param2Coeff.next();
-                        out[i] = custom_model.forward (inArray2);
-                        out[i] *= output_gain;
-                    }
+            if (!self->pipeline_late) {
+                self->pipeline_late = true;
+                if (self->pipeline_last != nullptr) {
+                    const uint32_t n = std::min(self->pipeline_last->n_samples, n_samples);
+                    applyCrossfade(out, self->pipeline_last->samples, n_samples, n);
                 }
             }
+            return true;
+        }
+        if (self->pipeline_late || !pipelined) {
+            // model is back on this thread, crossfade it in from what was last heard
+            if (self->pipeline_late) {
+                std::memcpy(result->samples, out, sizeof(float)*n_samples);
+            }
+            const uint32_t n = self->pipeline_late ? n_samples : std::min(result->n_samples, n_samples);
+            self->pipeline_late = false;
+            self->pipeline_last = nullptr;
+            applyModelInline(out, model, param1, param2, instance, n_samples);
+            applyCrossfade(out, result->samples, n_samples, n);
+            return true;
+        }
+    }
+
+    if (!pipelined)
+        return false;
+
+    if (result == nullptr) {
+        // first period of the mode, the helper is pinned off the audio thread core from its first block
+        self->pipeline_host_cpu = sched_getcpu();
+        self->pipeline_host_thread = pthread_self();
+    }
+
+    PipelineBlock* block = self->pipeline.input();
+    std::memcpy(block->samples, out, sizeof(float)*n_samples);
+    block->n_samples = n_samples;
+    block->model = model;
+    block->param1 = param1;
+    block->param2 = param2;
+    block->restart = self->model_restart;
+    block->host_cpu = self->pipeline_host_cpu;
+    block->host_thread = self->pipeline_host_thread;
+    self->model_restart = false;
+    self->pipeline.submit();
+    if (!self->pipeline.running()) {
+        requestPipelineWake(self); // helper parked just before the block got in
+    }
+
+    if (result != nullptr) {
+        self->pipeline_load = result->elapsed * self->samplerate / result->n_samples;
+        const uint32_t n = std::min(result->n_samples, n_samples);
+        std::memcpy(out, result->samples, sizeof(float)*n);
+        std::fill(out + n, out + n_samples, 0.0f);
+    } else {
+        std::fill(out, out + n_samples, 0.0f); /* First period after the mode is turned on */
+    }
+    self->pipeline_last = result;
+    return true;
+}
+
+/**
+ * Crossfades from the first n_from samples of from to out over the period, silence past n_from.
+ */
+void RtNeuralGeneric::applyCrossfade(float *out, const float *from, uint32_t n_samples, uint32_t n_from)
+{
+    const float step = 1.0f / n_samples;
+
+    for(uint32_t i=0; i<n_samples; i++) {
+        const float x = i < n_from ? from[i] : 0.0f;
+        out[i] = x + (out[i] - x) * (i + 1) * step;
+    }
+}
+
+/**
+ * Model stage of a block, on the helper thread.
+ */
+void RtNeuralGeneric::processPipelineBlock(void* instance, PipelineBlock& block)
+{
+    if (block.restart) {
+        restartModel(block.model, instance);
+    }
+#if AIDADSP_CONDITIONED_MODELS
+    setModelParams(block.model, block.param1, block.param2);
+#endif
+    applyModelOrIdle(block.samples, block.model, instance, block.n_samples);
+}
+#endif
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * CPU governor: the time spent in run is compared to the period deadline and averaged, in pipelined
+ * mode along with the helper time on its block, whichever is the larger. Above
+ * GOVERNOR_LOAD_HIGH it steps down one tier: flat eq bands skipped first, then the fallback model
+ * if one has been preloaded. There is no oversampling to turn off at the moment. Below
+ * GOVERNOR_LOAD_LOW for GOVERNOR_HOLD_UP seconds it steps back up. Tier changes go to the notify port.
+ */
+void RtNeuralGeneric::updateGovernor(LV2_Handle instance, std::chrono::steady_clock::time_point start, uint32_t n_samples)
+{
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
+    const float period = n_samples / self->samplerate;
+    const float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    const float alpha = std::min(period / GOVERNOR_TIME_CONSTANT, 1.0f);
+
+    float load = elapsed / period;
+#if AIDADSP_PIPELINE
+    load = std::max(load, self->pipeline_load);
+#endif
+
+    self->governor_load += (load - self->governor_load) * alpha;
+    self->governor_hold += period;
+
+    const bool has_fallback = self->model != nullptr && self->model->fallback != nullptr;
+    const int max_tier = has_fallback ? GOVERNOR_TIER_FALLBACK : GOVERNOR_TIER_EQ;
+    int tier = self->governor_tier;
+
+    if (self->governor_load > GOVERNOR_LOAD_HIGH && self->governor_hold >= GOVERNOR_HOLD_DOWN && tier < max_tier) {
+        tier++;
+    }
+    else if (self->governor_load < GOVERNOR_LOAD_LOW && self->governor_hold >= GOVERNOR_HOLD_UP && tier > GOVERNOR_TIER_FULL) {
+        tier--;
+    }
+    else if (tier > max_tier) { /* Fallback gone with a model change */
+        tier = max_tier;
+    }
+
+    if (tier == self->governor_tier)
+        return;
+
+    if (has_fallback && (tier == GOVERNOR_TIER_FALLBACK || self->governor_tier == GOVERNOR_TIER_FALLBACK)) {
+        /* Model switched, restarted by whoever runs it next */
+        self->model_restart = true;
+    }
+
+    self->governor_tier = tier;
+    self->governor_hold = 0.0f;
+
+#if AIDADSP_MODEL_LOADER
+    lv2_atom_forge_frame_time(&self->forge, 0);
+    write_set_int(&self->forge, &self->uris, self->uris.governorTier, tier);
 #endif
-        },
-        model->variant
-    );
 }
 
 /**********************************************************************************************************************************************************/
@@ -312,9 +567,24 @@ LV2_Handle RtNeuralGeneric::instantiate(const LV2_Descriptor* descriptor, double
     self->depth = new Biquad(bq_type_peak, DEPTH_FREQ / samplerate, DEPTH_Q, self->depth_boost_db_old);
     self->presence_boost_db_old = 0.0f;
     self->presence = new Biquad(bq_type_highshelf, PRESENCE_FREQ / samplerate, PRESENCE_Q, self->presence_boost_db_old);
+    self->tone_skipped = 0;
 
     self->last_input_size = 0;
 
+    self->forced_backend = AIDADSP_BACKEND_AUTO;
+    self->load_generation = 0;
+    self->loaded_model = nullptr;
+    self->loads_in_flight = 0;
+
+    self->silence_samples = 0;
+    self->model_idle = false;
+    self->idle_output = 0.0f;
+    self->model_restart = false;
+
+    self->governor_tier = GOVERNOR_TIER_FULL;
+    self->governor_load = 0.0f;
+    self->governor_hold = 0.0f;
+
     self->loading = true;
 
     // Initial model triggered by host default state load later on
@@ -327,6 +597,20 @@ LV2_Handle RtNeuralGeneric::instantiate(const LV2_Descriptor* descriptor, double
 
 #ifdef AIDADSP_CHANNELS
     self->channel_switch.resize(8);
+    self->channel = 0;
+    self->channel_fade_model = nullptr;
+    self->channel_fade_pos = 0;
+#endif
+
+#if AIDADSP_PIPELINE
+    // helper started by the worker when the mode is first turned on
+    self->pipeline_failed = false;
+    self->pipeline_unavailable = false;
+    self->pipeline_wake_pending = false;
+    self->pipeline_load = 0.0f;
+    self->pipeline_late = false;
+    self->pipeline_last = nullptr;
+    self->pipeline_host_cpu = -1;
 #endif
 
     return (LV2_Handle)self;
@@ -341,26 +625,23 @@ void RtNeuralGeneric::activate(LV2_Handle instance)
     self->preGain.clearToTargetValue();
     self->masterGain.clearToTargetValue();
 
+#if AIDADSP_PIPELINE
+    self->pipeline.reset();
+    self->pipeline_late = false;
+    self->pipeline_last = nullptr;
+#endif
+    self->model_restart = false;
+
     if (self->model == nullptr)
         return;
 
     // @TODO: include the activate function code here
     // @TODO: if (self->samplerate != self->model->samplerate) ???
-#if AIDADSP_CONDITIONED_MODELS
-    self->model->paramFirstRun = true;
-#endif
-#if 0
-    std::visit (
-        [] (auto&& custom_model)
-        {
-            using ModelType = std::decay_t<decltype (custom_model)>;
-            if constexpr (! std::is_same_v<ModelType, NullModel>)
-            {
-                custom_model.reset();
-            }
-        },
-        self->model->variant);
-    lv2_log_note(&self->logger, "%s %d: mdl rst!\n", __func__, __LINE__);
+#ifdef AIDADSP_CHANNELS
+    self->channel_fade_model = nullptr;
+    restartModel(self->model->channel_models[self->channel], instance);
+#else
+    restartModel(self->model, instance);
 #endif
 }
 
@@ -368,7 +649,14 @@ void RtNeuralGeneric::activate(LV2_Handle instance)
 
 void RtNeuralGeneric::deactivate(LV2_Handle instance)
 {
-    // @TODO: include the deactivate function code here
+#if AIDADSP_PIPELINE
+    RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
+
+    // block in flight would come back one period late on next activation
+    self->pipeline.reset();
+    self->pipeline_late = false;
+    self->pipeline_last = nullptr;
+#endif
 }
 
 /**********************************************************************************************************************************************************/
@@ -476,6 +764,27 @@ void RtNeuralGeneric::connect_port(LV2_Handle instance, uint32_t port, void *dat
         case PLUGIN_ENABLED:
             self->enabled = (float*) data;
             break;
+#if AIDADSP_SILENCE_CONTROLS
+        case SILENCE_THR:
+            self->silence_thr_db = (float*) data;
+            break;
+        case SILENCE_HOLD:
+            self->silence_hold_ms = (float*) data;
+            break;
+#endif
+#if AIDADSP_BACKEND_CONTROL
+        case BACKEND:
+            self->backend_port = (float*) data;
+            break;
+#endif
+#if AIDADSP_PIPELINE
+        case PIPELINE:
+            self->pipeline_port = (float*) data;
+            break;
+        case LATENCY:
+            self->latency_port = (float*) data;
+            break;
+#endif
     }
 }
 
@@ -499,15 +808,16 @@ void RtNeuralGeneric::run(LV2_Handle instance, uint32_t n_samples)
 #elif AIDADSP_PARAMS == 2
     const float param1 = *self->param1;
     const float param2 = *self->param2;
+#else
+    const float param1 = 0.f;
+    const float param2 = 0.f;
 #endif
 #ifdef AIDADSP_CHANNELS
-    std::vector<float> ctrls(8);
-#if AIDADSP_CHANNELS >= 1
-    ctrls[0] = *self->channel_switch[0];
-#if AIDADSP_CHANNELS >= 2
-    ctrls[1] = *self->channel_switch[1];
-#endif
-#endif
+    int channel = 0;
+    for (int i = 0; i < AIDADSP_CHANNELS; i++) {
+        if (*self->channel_switch[i] > 0.5f)
+            channel |= 1 << i;
+    }
 #endif
 
     self->preGain.setTargetValue(pregain);
@@ -516,6 +826,21 @@ void RtNeuralGeneric::run(LV2_Handle instance, uint32_t n_samples)
         self->in_lpf_pc_old = in_lpf_pc;
     }
     *self->input_size = self->last_input_size;
+#if AIDADSP_PIPELINE
+    if (*self->pipeline_port <= 0.5f) {
+        self->pipeline_failed = false;
+    }
+    const bool pipeline_on = *self->pipeline_port > 0.5f && !self->pipeline_failed && !self->pipeline_unavailable;
+    if (pipeline_on && !self->pipeline.running()) {
+        requestPipelineWake(self); // inline until the helper is up
+    }
+    const bool pipelined = pipeline_on && self->pipeline.running()
+        && self->model != nullptr && !net_bypass && n_samples <= PIPELINE_MAX_BLOCK;
+    *self->latency_port = pipelined ? static_cast<float>(n_samples) : 0.0f;
+    if (!pipelined) {
+        self->pipeline_load = 0.0f;
+    }
+#endif
 
 #if AIDADSP_COMMERCIAL && (AIDADSP_MODEL_DEFINE != SHOWCASE)
     self->run_count = mod_license_run_begin(self->run_count, n_samples);
@@ -546,62 +871,92 @@ void RtNeuralGeneric::run(LV2_Handle instance, uint32_t n_samples)
                         uris->patch_value,    &value,
                         0);
                 if (!property) {
-                    lv2_log_trace(&self->logger,
-                        "patch:Set message with no property\n");
+                    self->log_ring.log(kRtLogPatchNoProperty);
                     continue;
                 } else if (property->type != uris->atom_URID) {
-                    lv2_log_trace(&self->logger,
-                        "patch:Set property is not a URID\n");
+                    self->log_ring.log(kRtLogPatchPropertyNotUrid);
                     continue;
                 } else if (((const LV2_Atom_URID*)property)->body != uris->json) {
-                    lv2_log_trace(&self->logger,
-                        "patch:Set property body is not json\n");
+                    self->log_ring.log(kRtLogPatchPropertyNotJson);
                     continue;
                 }
                 if (!value) {
-                    lv2_log_trace(&self->logger,
-                        "patch:Set message with no value\n");
+                    self->log_ring.log(kRtLogPatchNoValue);
                     continue;
                 } else if (value->type != uris->atom_Path) {
-                    lv2_log_trace(&self->logger,
-                        "patch:Set value is not a Path\n");
+                    self->log_ring.log(kRtLogPatchValueNotPath);
                     continue;
                 }
 
                 // Json model file change, send it to the worker.
-                lv2_log_trace(&self->logger, "Queueing set message\n");
-                WorkerLoadMessage msg = { kWorkerLoad, {} };
+                self->log_ring.log(kRtLogQueueingSet);
+                WorkerLoadMessage msg = { kWorkerLoad, {}, self->forced_backend };
                 std::memcpy(msg.path, value + 1, std::min(value->size, static_cast<uint32_t>(sizeof(msg.path) - 1u)));
-                self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg);
+                scheduleLoad(self, msg);
                 self->loading = true;
             } else {
-                lv2_log_trace(&self->logger,
-                    "Unknown object type %d\n", obj->body.otype);
+                self->log_ring.log(kRtLogUnknownObjectType, obj->body.otype);
             }
         } else {
-            lv2_log_trace(&self->logger,
-                "Unknown event type %d\n", ev->body.type);
+            self->log_ring.log(kRtLogUnknownEventType, ev->body.type);
         }
     }
     /*++++++++ END READ ATOM MESSAGES ++++++++*/
 #endif
-#else
-#ifdef AIDADSP_CHANNELS
-    float model_index = controlsToModelIndex(*self->model_index, ctrls);
+
+#if AIDADSP_BACKEND_CONTROL
+    self->forced_backend = static_cast<int>(*self->backend_port + 0.5f);
+    if (self->model != nullptr && !self->loading && self->model->requested_backend != self->forced_backend) {
+        // Backend override changed, rebuild current model on it
+        self->log_ring.log(kRtLogQueueingSet);
+        WorkerLoadMessage msg = { kWorkerLoad, {}, self->forced_backend };
+        std::memcpy(msg.path, self->model->path, std::min(strlen(self->model->path), sizeof(msg.path) - 1u));
+        scheduleLoad(self, msg);
+        self->loading = true;
+    }
+#endif
 #else
     float model_index = *self->model_index;
-#endif
 
     if (model_index != self->model_index_old) {
         self->model_index_old = model_index;
 
         // Json model file change, send it to the worker.
-        lv2_log_trace(&self->logger, "Queueing set message\n");
+        self->log_ring.log(kRtLogQueueingSet);
+#ifdef AIDADSP_CHANNELS
+        // models of all channels get loaded, channel switches pick one of them
+        WorkerLoadMessage msg = { kWorkerLoad, static_cast<int>(model_index) };
+#else
         WorkerLoadMessage msg = { kWorkerLoad, static_cast<int>(model_index + 1.5f) }; // round to int + 1
-        self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg);
+#endif
+        scheduleLoad(self, msg);
         self->loading = true;
     }
+
+#ifdef AIDADSP_CHANNELS
+    if (channel != self->channel) {
+        // resident model of the new channel starts from its warm state, the old one fades out
+        if (self->model != nullptr && !net_bypass) {
+            DynamicModel* from = self->model->channel_models[self->channel];
+            if (from != self->model->channel_models[channel]) {
+                self->channel_fade_model = from;
+                self->channel_fade_pos = 0;
+                self->model_restart = true;
+            }
+        }
+        self->channel = channel;
+    }
 #endif
+#endif
+
+    // model loaded by the pool, swapped in by work_response
+    if (DynamicModel* loaded = self->loaded_model.exchange(nullptr, std::memory_order_acquire)) {
+        WorkerApplyMessage msg = { kWorkerApply, loaded, loaded->generation };
+        self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg);
+    }
+
+    // messages logged so far, the ones from the dsp below go out with the next run
+    requestLogFlush(self);
 
     // 0 samples means pre-run, nothing left for us to do
     if (n_samples == 0) {
@@ -619,6 +974,7 @@ void RtNeuralGeneric::run(LV2_Handle instance, uint32_t n_samples)
     }
 
     /*++++++++ AUDIO DSP ++++++++*/
+    const std::chrono::steady_clock::time_point dsp_start = std::chrono::steady_clock::now();
     if (in_lpf_pc != 0.0f) {
         applyBiquadFilter(self->out_1, self->in, self->in_lpf, n_samples); // High frequencies roll-off (lowpass)
     } else {
@@ -628,18 +984,41 @@ void RtNeuralGeneric::run(LV2_Handle instance, uint32_t n_samples)
     if(eq_position == 1.0f && eq_bypass == 0.0f) {
         applyToneControls(self->out_1, self->out_1, instance, n_samples); // Equalizer section
     }
+#if AIDADSP_PIPELINE
+    if (self->model == nullptr || net_bypass) {
+        self->pipeline.collect(); // model stage skipped, block in flight is stale
+    }
+#endif
     if (self->model != nullptr) {
         if (!net_bypass) {
+            DynamicModel* model = self->model;
+#ifdef AIDADSP_CHANNELS
+            model = model->channel_models[self->channel];
+            uint32_t n_fade = 0;
+            if (self->channel_fade_model != nullptr) {
+                // previous channel model on a copy of the input, for the crossfade
+                n_fade = std::min(n_samples, CHANNEL_FADE_SAMPLES - self->channel_fade_pos);
+                std::memcpy(self->channel_fade, self->out_1, sizeof(float)*n_fade);
 #if AIDADSP_CONDITIONED_MODELS
-            self->model->param1Coeff.setTargetValue(param1);
-            self->model->param2Coeff.setTargetValue(param2);
-            if (self->model->paramFirstRun) {
-                self->model->paramFirstRun = false;
-                self->model->param1Coeff.clearToTargetValue();
-                self->model->param2Coeff.clearToTargetValue();
+                setModelParams(self->channel_fade_model, param1, param2);
+#endif
+                applyModel(self->channel_fade_model, self->channel_fade, n_fade);
+            }
+#endif
+            if (self->governor_tier >= GOVERNOR_TIER_FALLBACK && model->fallback != nullptr) {
+                model = model->fallback;
+            }
+#if AIDADSP_PIPELINE
+            if (!applyModelPipelined(self->out_1, model, param1, param2, instance, n_samples, pipelined))
+#endif
+            {
+                applyModelInline(self->out_1, model, param1, param2, instance, n_samples);
+            }
+#ifdef AIDADSP_CHANNELS
+            if (n_fade > 0) {
+                applyChannelFade(self->out_1, self->channel_fade, instance, n_fade);
             }
 #endif
-            applyModel(self->model, self->out_1, n_samples);
         }
     }
 #if AIDADSP_OPTIONAL_DCBLOCKER
@@ -653,6 +1032,7 @@ void RtNeuralGeneric::run(LV2_Handle instance, uint32_t n_samples)
     }
     self->masterGain.setTargetValue(self->loading ? 0.f : master);
     applyGainRamp(self->masterGain, self->out_1, self->out_1, n_samples); // Master volume
+    updateGovernor(instance, dsp_start, n_samples);
 #if AIDADSP_COMMERCIAL && (AIDADSP_MODEL_DEFINE != SHOWCASE)
     mod_license_run_silence(self->run_count, self->out_1, n_samples, 0);
 #endif
@@ -665,7 +1045,17 @@ void RtNeuralGeneric::cleanup(LV2_Handle instance)
 {
     RtNeuralGeneric *self = (RtNeuralGeneric*) instance;
 
+#if AIDADSP_PIPELINE
+    self->pipeline.stop();
+#endif
+    // loads in the pool give up at their next check, then none is left to write back
+    self->load_generation++;
+    while (self->loads_in_flight > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    freeModel (self->loaded_model.exchange(nullptr));
     freeModel (self->model);
+    self->log_ring.flush(&self->logger);
     delete self->dc_blocker;
     delete self->in_lpf;
     delete self->bass;
@@ -726,7 +1116,7 @@ LV2_State_Status RtNeuralGeneric::restore(LV2_Handle instance,
         lv2_log_note(&self->logger, "Restoring file %s\n", (const char*)value);
 
         // send to worker for loading
-        WorkerLoadMessage msg = { kWorkerLoad, {} };
+        WorkerLoadMessage msg = { kWorkerLoad, {}, self->forced_backend };
 
         LV2_State_Map_Path* map_path = NULL;
         LV2_State_Free_Path* free_path = NULL;
@@ -752,7 +1142,7 @@ LV2_State_Status RtNeuralGeneric::restore(LV2_Handle instance,
             std::memcpy(msg.path, value, std::min(size, sizeof(msg.path) - 1u));
         }
 
-        self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg);
+        scheduleLoad(self, msg);
     }
 
     return LV2_STATE_SUCCESS;
@@ -799,49 +1189,116 @@ LV2_State_Status RtNeuralGeneric::save(LV2_Handle instance,
 /**********************************************************************************************************************************************************/
 
 /**
- * Do work in a non-realtime thread.
- * This is called for every piece of work scheduled in the audio thread using
- * self->schedule->schedule_work(). A reply can be sent back to the audio
- * thread using the provided respond function.
+ * Queue a model load in the worker. Each load gets a new generation, so the worker skips or aborts
+ * the ones superseded while queued and only the newest reaches work_response: sweeping a selector
+ * costs a single load.
  */
-LV2_Worker_Status RtNeuralGeneric::work(LV2_Handle instance,
-    LV2_Worker_Respond_Function respond,
-    LV2_Worker_Respond_Handle   handle,
-    uint32_t                    size,
-    const void*                 data)
+void RtNeuralGeneric::scheduleLoad(RtNeuralGeneric* self, WorkerLoadMessage& msg)
 {
-    RtNeuralGeneric* self = (RtNeuralGeneric*) instance;
-    const WorkerMessage* msg = (const WorkerMessage*)data;
-    float param1 = 0.0f;
-    float param2 = 0.0f;
+    msg.generation = self->load_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+    self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg);
+}
 
-    switch (msg->type)
-    {
-    case kWorkerLoad:
-#if AIDADSP_CONDITIONED_MODELS
-        if (self->model != nullptr) {
+/**
+ * Have the worker write messages logged by the audio thread, at most one flush is queued at a
+ * time. A flush lost to a full worker queue is done by the next worker job.
+ */
+void RtNeuralGeneric::requestLogFlush(RtNeuralGeneric* self)
+{
+    if (self->log_ring.flushNeeded()) {
+        WorkerMessage msg = { kWorkerLog };
+        self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg);
+    }
+}
+
+#if AIDADSP_PIPELINE
+/**
+ * Have the worker start the pipeline helper, or wake it up when parked, at most one request is
+ * queued at a time. The helper is only started once the mode is first turned on.
+ */
+void RtNeuralGeneric::requestPipelineWake(RtNeuralGeneric* self)
+{
+    if (self->pipeline_wake_pending)
+        return;
+    WorkerPipelineMessage msg = { kWorkerPipeline, true };
+    self->pipeline_wake_pending = self->schedule->schedule_work(self->schedule->handle, sizeof(msg), &msg) == LV2_WORKER_SUCCESS;
+}
+#endif
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Do work in a non-realtime thread.
+ * This is called for every piece of work scheduled in the audio thread using
+ * self->schedule->schedule_work(). A reply can be sent back to the audio
+ * thread using the provided respond function.
+ */
+LV2_Worker_Status RtNeuralGeneric::work(LV2_Handle instance,
+    LV2_Worker_Respond_Function respond,
+    LV2_Worker_Respond_Handle   handle,
+    uint32_t                    size,
+    const void*                 data)
+{
+    RtNeuralGeneric* self = (RtNeuralGeneric*) instance;
+    const WorkerMessage* msg = (const WorkerMessage*)data;
+    float param1 = 0.0f;
+    float param2 = 0.0f;
+    LoadToken token;
+
+    // messages logged by the audio thread
+    self->log_ring.flush(&self->logger);
+
+    switch (msg->type)
+    {
+    case kWorkerLoad:
+        token = { &self->load_generation, ((const WorkerLoadMessage*)data)->generation };
+        if (token.stale()) {
+            // a newer load is queued behind this one
+            lv2_log_trace(&self->logger, "Skipping superseded load\n");
+            return LV2_WORKER_SUCCESS;
+        }
+#if AIDADSP_CONDITIONED_MODELS
+        if (self->model != nullptr) {
             param1 = self->model->param1Coeff.getTargetValue();
             param2 = self->model->param2Coeff.getTargetValue();
         }
 #endif
-#if AIDADSP_MODEL_LOADER
-        if (DynamicModel* newmodel = RtNeuralGeneric::loadModelFromPath(&self->logger, ((const WorkerLoadMessage*)data)->path, &self->last_input_size, param1, param2))
-#else
-        if (DynamicModel* newmodel = RtNeuralGeneric::loadModelFromIndex(&self->logger, ((const WorkerLoadMessage*)data)->modelIndex, &self->last_input_size, param1, param2))
-#endif
-        {
-            WorkerApplyMessage reply = { kWorkerApply, newmodel };
-            respond (handle, sizeof(reply), &reply);
-        }
+        // load in the pool, leaving this thread to the other instances, run picks the model up
+        self->loads_in_flight++;
+        LoaderPool::instance().submit([self, load = *(const WorkerLoadMessage*)data, token, param1, param2] {
+            loadModel(self, load, token, param1, param2);
+            self->loads_in_flight--;
+        });
         return LV2_WORKER_SUCCESS;
 
     case kWorkerFree:
+#if AIDADSP_PIPELINE
+        // the helper may still be running the old model on the block in flight
+        self->pipeline.sync();
+#endif
         freeModel (((const WorkerApplyMessage*)data)->model);
         return LV2_WORKER_SUCCESS;
 
     case kWorkerApply:
-        // should not happen!
-        break;
+        // model loaded by the pool and collected by run, on to work_response
+        respond (handle, size, data);
+        return LV2_WORKER_SUCCESS;
+
+    case kWorkerLog:
+        // flushed above
+        return LV2_WORKER_SUCCESS;
+
+    case kWorkerPipeline:
+#if AIDADSP_PIPELINE
+        {
+            WorkerPipelineMessage reply = { kWorkerPipeline, self->pipeline.start(processPipelineBlock, self) };
+            if (!reply.available) {
+                lv2_log_note(&self->logger, "Model pipeline not available, processing inline\n");
+            }
+            respond (handle, sizeof(reply), &reply);
+        }
+#endif
+        return LV2_WORKER_SUCCESS;
     }
 
     return LV2_WORKER_ERR_UNKNOWN;
@@ -849,6 +1306,34 @@ LV2_Worker_Status RtNeuralGeneric::work(LV2_Handle instance,
 
 /**********************************************************************************************************************************************************/
 
+/**
+ * Load a model in a loader pool thread and leave it for run to collect. The newest load wins: a
+ * model is only left if no newer load has been scheduled, checked under the lock so a slower older
+ * load can't replace a newer model. A model left earlier and not collected yet is superseded.
+ */
+void RtNeuralGeneric::loadModel(RtNeuralGeneric* self, const WorkerLoadMessage& msg, const LoadToken& token, float param1, float param2)
+{
+#if AIDADSP_MODEL_LOADER
+    DynamicModel* newmodel = loadModelFromPath(&self->logger, msg.path, param1, param2, msg.backend, token);
+#elif defined(AIDADSP_CHANNELS)
+    DynamicModel* newmodel = loadChannelModels(&self->logger, msg.modelIndex, param1, param2, token);
+#else
+    DynamicModel* newmodel = loadModelFromIndex(&self->logger, msg.modelIndex, param1, param2, token);
+#endif
+    if (newmodel == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(self->loaded_model_mutex);
+    if (token.stale()) {
+        freeModel(newmodel);
+        return;
+    }
+    newmodel->generation = token.generation;
+    freeModel(self->loaded_model.exchange(newmodel, std::memory_order_acq_rel));
+}
+
+/**********************************************************************************************************************************************************/
+
 /**
  * Handle a response from work() in the audio thread.
  *
@@ -862,20 +1347,44 @@ LV2_Worker_Status RtNeuralGeneric::work_response(LV2_Handle instance, uint32_t s
 
     const WorkerMessage* const msg = static_cast<const WorkerMessage*>(data);
 
+#if AIDADSP_PIPELINE
+    if (msg->type == kWorkerPipeline) {
+        self->pipeline_wake_pending = false;
+        self->pipeline_unavailable = !static_cast<const WorkerPipelineMessage*>(data)->available;
+        return LV2_WORKER_SUCCESS;
+    }
+#endif
+
     if (msg->type != kWorkerApply)
         return LV2_WORKER_ERR_UNKNOWN;
 
+    const WorkerApplyMessage* apply = static_cast<const WorkerApplyMessage*>(data);
+
+    if (apply->generation != self->load_generation.load(std::memory_order_relaxed)) {
+        // superseded while loading, the newer model is on its way
+        WorkerApplyMessage reply = { kWorkerFree, apply->model };
+        self->schedule->schedule_work(self->schedule->handle, sizeof(reply), &reply);
+        self->log_ring.log(kRtLogDroppingSuperseded);
+        requestLogFlush(self);
+        return LV2_WORKER_SUCCESS;
+    }
+
     // prepare reply for deleting old model
     WorkerApplyMessage reply = { kWorkerFree, self->model };
 
-    // swap current model with new one
-    self->model = static_cast<const WorkerApplyMessage*>(data)->model;
+    // swap current model with new one, it comes out of the worker already in its warm state
+    self->model = apply->model;
+    self->model_restart = true;
+    self->last_input_size = self->model->input_size;
+#ifdef AIDADSP_CHANNELS
+    self->channel_fade_model = nullptr;
+#endif
 
     // send reply
     self->schedule->schedule_work(self->schedule->handle, sizeof(reply), &reply);
 
     // log about new model in use
-    lv2_log_trace(&self->logger, "New model in use\n");
+    self->log_ring.log(kRtLogNewModel);
 
 #if AIDADSP_MODEL_LOADER
     // report change to host/ui
@@ -884,10 +1393,24 @@ LV2_Worker_Status RtNeuralGeneric::work_response(LV2_Handle instance, uint32_t s
                    &self->uris,
                    self->model->path,
                    strlen(self->model->path));
+
+    // report expected cost at current samplerate
+    lv2_atom_forge_frame_time(&self->forge, 0);
+    write_set_cost(&self->forge,
+                   &self->uris,
+                   self->model->type.c_str(),
+                   self->model->backend->name,
+                   self->model->hidden_size,
+                   self->model->input_size,
+                   self->model->ns_per_sample,
+                   self->model->ns_per_sample * self->samplerate * 1e-7f,
+                   self->model->memory_size,
+                   self->model->locked);
 #endif
 
     self->loading = false;
-    lv2_log_trace(&self->logger, "loading = false\n");
+    self->log_ring.log(kRtLogLoadingDone);
+    requestLogFlush(self);
 
     return LV2_WORKER_SUCCESS;
 }
@@ -900,11 +1423,6 @@ LV2_Worker_Status RtNeuralGeneric::work_response(LV2_Handle instance, uint32_t s
 bool RtNeuralGeneric::testModel(LV2_Log_Logger* logger, DynamicModel *model, const std::vector<float>& xData, const std::vector<float>& yData)
 {
     std::unique_ptr<float[]> out(new float [xData.size()]);
-    float in_gain = model->input_gain;
-    float out_gain = model->output_gain;
-    /* Gain correction inject unwanted errors */
-    model->input_gain = 1.f;
-    model->output_gain = 1.f;
 #if AIDADSP_CONDITIONED_MODELS
     /* Conditioned models tested with all params at 0 */
     float param1 = model->param1Coeff.getTargetValue();
@@ -919,8 +1437,6 @@ bool RtNeuralGeneric::testModel(LV2_Log_Logger* logger, DynamicModel *model, con
     }
     applyModel(model, out.get(), xData.size());
     /* Restore params previously saved */
-    model->input_gain = in_gain;
-    model->output_gain = out_gain;
 #if AIDADSP_CONDITIONED_MODELS
     model->param1Coeff.setTargetValue(param1);
     model->param1Coeff.clearToTargetValue();
@@ -956,28 +1472,364 @@ bool RtNeuralGeneric::testModel(LV2_Log_Logger* logger, DynamicModel *model, con
 
 /**********************************************************************************************************************************************************/
 
+/**
+ * This function runs load time optimizations on a freshly parsed model, in the worker thread.
+ * Input gain is folded into the first layer input weights of the audio input and output gain into
+ * the last dense layer, leaving only the input skip gain to applyModel.
+ */
+void RtNeuralGeneric::optimizeModel(LV2_Log_Logger* logger, DynamicModel* model, const nlohmann::json& model_json)
+{
+    model->skip_gain = model->input_gain * model->output_gain;
+
+    if (model->input_gain == 1.0f && model->output_gain == 1.0f)
+        return;
+
+    /* Convolutional models fold gains into their kernels when built, see conv-engine.cpp */
+    if (model->backend->id == AIDADSP_BACKEND_CONV)
+        return;
+
+    /* First layer kernel is in_size x gates, last dense layer kernel is in_size x 1 */
+    const nlohmann::json& json_layers = model_json.at("layers");
+    foldModelGains(logger, model, json_layers.front().at("weights").at(0).get<std::vector<std::vector<float>>>(),
+        json_layers.back().at("weights").at(0).get<std::vector<std::vector<float>>>(), json_layers.back().at("weights").at(1).get<std::vector<float>>());
+}
+
+/**
+ * This function folds the model gains into the engine copy of the first layer kernel, audio input
+ * is row 0, and of the last dense layer, with these as found in the model file.
+ */
+void RtNeuralGeneric::foldModelGains(LV2_Log_Logger* logger, DynamicModel* model, std::vector<std::vector<float>> kernel, const std::vector<std::vector<float>>& dense_kernel, std::vector<float> dense_bias)
+{
+    const float input_gain = model->input_gain;
+    const float output_gain = model->output_gain;
+
+    for (float& w : kernel.front()) {
+        w *= input_gain;
+    }
+
+    std::vector<std::vector<float>> dense_weights(1, std::vector<float>(dense_kernel.size()));
+    for (size_t i = 0; i < dense_kernel.size(); i++) {
+        dense_weights[0][i] = dense_kernel[i][0] * output_gain;
+    }
+    dense_bias[0] *= output_gain;
+
+    model->engine->setInputKernel(kernel);
+    model->engine->setOutputLayer(dense_weights, dense_bias);
+
+    lv2_log_note(logger, "Folded in_gain %.3f dB and out_gain %.3f dB into model weights\n", CO_DB(input_gain), CO_DB(output_gain));
+}
+
+/**********************************************************************************************************************************************************/
+
+/* CPU time of the calling thread, unlike wall time it does not count while the thread is preempted */
+static double threadTimeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * This function measures the model cost in the worker thread, with the actual build flags on the
+ * actual CPU, so that the expected DSP load can be reported before the model goes live. Loads of
+ * several instances benchmark side by side in the loader pool, one core each, so the thread CPU time
+ * is measured rather than wall time. Model state is restored afterwards, so it must be called once
+ * the warm state has been saved.
+ */
+void RtNeuralGeneric::benchmarkModel(LV2_Log_Logger* logger, DynamicModel* model)
+{
+    float buffer[BENCHMARK_SAMPLES];
+    double best = 0.0;
+
+    for (int run = 0; run < BENCHMARK_RUNS; run++) {
+        for (int i = 0; i < BENCHMARK_SAMPLES; i++) {
+            buffer[i] = 0.1f * sinf(2.0f * M_PI * 110.0f * i / 48000.0f);
+        }
+        const double start = threadTimeNs();
+        applyModel(model, buffer, BENCHMARK_SAMPLES);
+        const double elapsed = threadTimeNs() - start;
+        if (run == 0 || elapsed < best)
+            best = elapsed;
+    }
+    model->restoreState();
+
+    model->ns_per_sample = static_cast<float>(best / BENCHMARK_SAMPLES);
+    const std::string info = model->engine->getInfo();
+    lv2_log_note(logger, "Model %s %d input_size %d on %s: %.1f ns/sample%s%s\n", model->type.c_str(), model->hidden_size, model->input_size,
+        model->backend->name, model->ns_per_sample, info.empty() ? "" : ", ", info.c_str());
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * This function makes model memory resident before the model is handed to the audio thread, so
+ * that the first run does not page fault. Every page of the model arena is touched, big chunks are
+ * asked to be backed by transparent huge pages, and with AIDADSP_MLOCK pages are locked so they
+ * can't be swapped out. Arena pages belong to this model only, they are unlocked in freeModel.
+ */
+void RtNeuralGeneric::prefaultModel(LV2_Log_Logger* logger, DynamicModel* model)
+{
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    model->memory_size = sizeof(DynamicModel) + model->engine->getMemorySize();
+    model->locked = false;
+    int lock_error = 0;
+
+    model->arena.forEachChunk([page_size](void* data, size_t size) {
+#ifdef MADV_HUGEPAGE
+        if (size >= HUGE_PAGE_SIZE)
+            madvise(data, size, MADV_HUGEPAGE);
+#endif
+        /* Write back what is there, read only faults could map the shared zero page */
+        volatile char* bytes = static_cast<volatile char*>(data);
+        for (size_t i = 0; i < size; i += page_size)
+            bytes[i] = bytes[i];
+    });
+
+#if AIDADSP_MLOCK
+    model->locked = model->arena.lock();
+    if (!model->locked)
+        lock_error = errno;
+#endif
+
+    if (AIDADSP_MLOCK && !model->locked)
+        lv2_log_warning(logger, "Model memory %zu bytes in %zu bytes of pages prefaulted, not locked: %s\n", model->memory_size, model->arena.size(), strerror(lock_error));
+    else
+        lv2_log_note(logger, "Model memory %zu bytes in %zu bytes of pages prefaulted%s\n", model->memory_size, model->arena.size(), model->locked ? " and locked" : "");
+}
+
+/**********************************************************************************************************************************************************/
+
+/**
+ * Builds the model header in place at the start of its arena, after its engine, with what does not
+ * depend on the model file. The arena goes with the model, see freeModel.
+ */
+static DynamicModel* newModelHeader(ModelArena&& arena, ModelEngine* engine, const ModelBackend* model_backend, const char* name, const float old_param1, const float old_param2)
+{
+    DynamicModel* model = new (arena.header()) DynamicModel();
+    model->arena = std::move(arena);
+    model->engine = engine;
+    model->backend = model_backend;
+    model->requested_backend = AIDADSP_BACKEND_AUTO;
 #if AIDADSP_MODEL_LOADER
+    model->path = strdup(name);
+#else
+    (void)name;
+#endif
+    model->fallback = nullptr;
+#ifdef AIDADSP_CHANNELS
+    std::fill(model->channel_models, model->channel_models + CHANNEL_COMBINATIONS, nullptr);
+#endif
+    model->ns_per_sample = 0.0f;
+    model->memory_size = 0;
+    model->locked = false;
+    model->generation = 0;
+#if AIDADSP_CONDITIONED_MODELS
+    model->param1Coeff.setTargetValue(old_param1);
+    model->param2Coeff.setTargetValue(old_param2);
+    model->paramFirstRun = true;
+#else
+    (void)old_param1;
+    (void)old_param2;
+#endif
+#if AIDADSP_FOLD_PARAMS
+    model->n_params = 0;
+    model->foldedParam1 = NAN; /* Force first fold */
+    model->foldedParam2 = NAN;
+#endif
+    return model;
+}
+
+/* Params smoothers run at the model samplerate, from the params of the model being replaced */
+static void setModelParamsRate(DynamicModel* model)
+{
+#if AIDADSP_CONDITIONED_MODELS
+    model->param1Coeff.setSampleRate(model->samplerate);
+    model->param1Coeff.setTimeConstant(0.1f);
+    model->param1Coeff.clearToTargetValue();
+    model->param2Coeff.setSampleRate(model->samplerate);
+    model->param2Coeff.setTimeConstant(0.1f);
+    model->param2Coeff.clearToTargetValue();
+#else
+    (void)model;
+#endif
+}
+
+/**********************************************************************************************************************************************************/
+
+#if AIDADSP_MODEL_LOADER
+/**
+ * This function writes the image of a model built from a json file, read back by restoreModel.
+ * model_json is the model as built, params split out. Engines which can't read their weights back
+ * take them from a copy of it, with gains folded as optimizeModel did.
+ */
+void RtNeuralGeneric::serializeModel(const DynamicModel* model, const nlohmann::json& model_json, ModelImage& image)
+{
+    image.put<int32_t>(model->backend->id);
+    image.put<float>(model->ns_per_sample);
+    image.put<uint8_t>(model->input_skip);
+    image.put<float>(model->input_gain);
+    image.put<float>(model->output_gain);
+    image.put<float>(model->skip_gain);
+    image.put<float>(model->samplerate);
+    image.putString(model->type);
+    image.put<int32_t>(model->hidden_size);
+    image.put<int32_t>(model->input_size);
+#if AIDADSP_FOLD_PARAMS
+    image.put<int32_t>(model->n_params);
+    if (model->n_params > 0) {
+        image.putVector(model->paramWeights[0]);
+        image.putVector(model->paramWeights[1]);
+        image.putVector(model->paramBias);
+        image.put<uint64_t>(model->foldedBias.size());
+        for (const std::vector<float>& bias : model->foldedBias)
+            image.putVector(bias);
+    }
+#endif
+
+    if (model->backend->id > AIDADSP_BACKEND_STL || (model->input_gain == 1.0f && model->output_gain == 1.0f)) {
+        model->engine->serialize(image, model_json);
+        return;
+    }
+
+    /* Same products as optimizeModel, so restored weights are bit exact */
+    nlohmann::json folded_json = model_json;
+    nlohmann::json& json_layers = folded_json.at("layers");
+    for (nlohmann::json& w : json_layers.front().at("weights").at(0).at(0))
+        w = w.get<float>() * model->input_gain;
+    nlohmann::json& dense_weights = json_layers.back().at("weights");
+    for (nlohmann::json& row : dense_weights.at(0))
+        row.at(0) = row.at(0).get<float>() * model->output_gain;
+    dense_weights.at(1).at(0) = dense_weights.at(1).at(0).get<float>() * model->output_gain;
+    model->engine->serialize(image, folded_json);
+}
+
+/**
+ * This function builds a model back from its image, see serializeModel: no json is parsed, the
+ * engine gets its folded weights and its warm state straight from the image and the model cost is
+ * known already, so it neither warms up nor gets benchmarked. Throws on a bad image.
+ */
+DynamicModel* RtNeuralGeneric::restoreModel(LV2_Log_Logger* logger, ModelImageReader image, const char* name, const float old_param1, const float old_param2)
+{
+    const int backend_id = image.get<int32_t>();
+    const ModelBackend* model_backend = nullptr;
+    for (int i = 0; model_backends[i] != nullptr; i++) {
+        if (model_backends[i]->id == backend_id)
+            model_backend = model_backends[i];
+    }
+    for (const ModelBackend* other_backend : { &model_backend_conv, &model_backend_sparse, &model_backend_lowrank }) {
+        if (other_backend->id == backend_id)
+            model_backend = other_backend;
+    }
+    if (model_backend == nullptr)
+        throw std::runtime_error("Backend " + std::to_string(backend_id) + " not available");
+
+    const float ns_per_sample = image.get<float>();
+    const bool input_skip = image.get<uint8_t>() != 0;
+    const float input_gain = image.get<float>();
+    const float output_gain = image.get<float>();
+    const float skip_gain = image.get<float>();
+    const float model_samplerate = image.get<float>();
+    std::string type = image.getString();
+    const int hidden_size = image.get<int32_t>();
+    const int input_size = image.get<int32_t>();
+#if AIDADSP_FOLD_PARAMS
+    const int n_params = image.get<int32_t>();
+    std::vector<float> param_weights[2];
+    std::vector<float> param_bias;
+    std::vector<std::vector<float>> folded_bias;
+    if (n_params > 0) {
+        image.getVector(param_weights[0]);
+        image.getVector(param_weights[1]);
+        image.getVector(param_bias);
+        const uint64_t bias_rows = image.get<uint64_t>();
+        if (bias_rows < 1 || bias_rows > 2)
+            throw std::runtime_error("Bad folded bias in model image");
+        folded_bias.resize(bias_rows);
+        for (std::vector<float>& bias : folded_bias)
+            image.getVector(bias);
+    }
+#endif
+
+    ModelArena arena(sizeof(DynamicModel));
+    ModelEngine* engine = model_backend->restore(image, arena);
+    DynamicModel* model = newModelHeader(std::move(arena), engine, model_backend, name, old_param1, old_param2);
+    model->ns_per_sample = ns_per_sample;
+    model->input_skip = input_skip;
+    model->input_gain = input_gain;
+    model->output_gain = output_gain;
+    model->skip_gain = skip_gain;
+    model->samplerate = model_samplerate;
+    model->type = std::move(type);
+    model->hidden_size = hidden_size;
+    model->input_size = input_size;
+    setModelParamsRate(model);
+#if AIDADSP_FOLD_PARAMS
+    model->n_params = n_params;
+    model->paramWeights[0] = std::move(param_weights[0]);
+    model->paramWeights[1] = std::move(param_weights[1]);
+    model->paramBias = std::move(param_bias);
+    model->foldedBias = std::move(folded_bias);
+#endif
+
+    const std::string info = model->engine->getInfo();
+    lv2_log_note(logger, "Model %s %d input_size %d on %s: %.1f ns/sample%s%s\n", model->type.c_str(), model->hidden_size, model->input_size,
+        model->backend->name, model->ns_per_sample, info.empty() ? "" : ", ", info.c_str());
+    prefaultModel(logger, model);
+
+    return model;
+}
+#endif
+
+/**********************************************************************************************************************************************************/
+
 /**
- * This function loads a pre-trained neural model from a json file
+ * This function builds a pre-trained neural model from its json description, name is the model
+ * file path in loader builds. Params are split out of model_json, which is left as built.
 */
-DynamicModel* RtNeuralGeneric::loadModelFromPath(LV2_Log_Logger* logger, const char* path, int* input_size_ptr, const float old_param1, const float old_param2)
+DynamicModel* RtNeuralGeneric::createModel(LV2_Log_Logger* logger, nlohmann::json& model_json, const char* name, const float old_param1, const float old_param2, int backend, const LoadToken& token)
 {
     int input_skip;
     int input_size;
+#if AIDADSP_FOLD_PARAMS
+    std::vector<float> param_weights[2];
+    std::vector<std::vector<float>> rnn_bias;
+#endif
     float input_gain;
     float output_gain;
     float model_samplerate;
-    nlohmann::json model_json;
+    bool conv_model;
+    bool sparse_model;
+    bool lowrank_model;
 
     try {
-        std::ifstream jsonStream(path, std::ifstream::binary);
-        jsonStream >> model_json;
-
         /* Understand which model type to load */
         input_size = model_json["in_shape"].back().get<int>();
-        if (input_size > MAX_INPUT_SIZE) {
+        if (input_size > AIDADSP_PARAMS + 1) {
             throw std::invalid_argument("Value for input_size not supported");
         }
+        conv_model = model_json["layers"][0]["type"] == "conv1d";
+        sparse_model = !conv_model && isSparseModel(model_json);
+        lowrank_model = !conv_model && isLowRankModel(model_json);
+
+#if AIDADSP_FOLD_PARAMS
+        if (input_size > 1 && !conv_model) {
+            /* Split params input weights and bias from the recurrent layer, leaving a snapshot model */
+            nlohmann::json& rnn_weights = model_json["layers"][0]["weights"];
+            const size_t gates_size = rnn_weights[0][0].size();
+            for (int i = 0; i < 2; i++) {
+                if (i + 1 < input_size)
+                    param_weights[i] = rnn_weights[0][i + 1].get<std::vector<float>>();
+                else
+                    param_weights[i].assign(gates_size, 0.0f);
+            }
+            if (model_json["layers"][0]["type"] == "gru")
+                rnn_bias = rnn_weights[2].get<std::vector<std::vector<float>>>();
+            else
+                rnn_bias = { rnn_weights[2].get<std::vector<float>>() };
+            rnn_weights[0] = nlohmann::json::array({ rnn_weights[0][0] });
+            model_json["in_shape"].back() = 1;
+        }
+#endif
 
         if (model_json["in_skip"].is_number()) {
             input_skip = model_json["in_skip"].get<int>();
@@ -1011,79 +1863,377 @@ DynamicModel* RtNeuralGeneric::loadModelFromPath(LV2_Log_Logger* logger, const c
         else {
             model_samplerate = 48000.0f;
         }
-
-        lv2_log_note(logger, "Successfully loaded json file: %s\n", path);
     }
     catch (const std::exception& e) {
-        lv2_log_error(logger, "Unable to load json file: %s\nError: %s\n", path, e.what());
+        lv2_log_error(logger, "Unable to load model: %s\nError: %s\n", name, e.what());
         return nullptr;
     }
 
-    std::unique_ptr<DynamicModel> model = std::make_unique<DynamicModel>();
+    if (token.stale()) {
+        lv2_log_trace(logger, "Load of %s superseded\n", name);
+        return nullptr;
+    }
+
+    /**
+     * Each backend tried gets a model of its own: the engine is built in a fresh arena, in place after
+     * room left for the model header, which is then filled in with what has been found above.
+     */
+    const auto newModel = [&](const ModelBackend* model_backend) -> DynamicModel* {
+        ModelArena arena(sizeof(DynamicModel));
+        ModelEngine* engine = model_backend->create(model_json, arena);
+        DynamicModel* model = newModelHeader(std::move(arena), engine, model_backend, name, old_param1, old_param2);
+
+        /* Save extra info */
+        model->requested_backend = backend;
+        model->input_skip = input_skip != 0;
+        model->input_gain = input_gain;
+        model->output_gain = output_gain;
+        model->skip_gain = 1.0f;
+        model->samplerate = model_samplerate;
+        model->type = model_json["layers"][0]["type"].get<std::string>();
+        model->hidden_size = model_json["layers"][0]["shape"].back().get<int>();
+        model->input_size = input_size;
+        setModelParamsRate(model);
+#if AIDADSP_FOLD_PARAMS
+        model->n_params = conv_model ? 0 : input_size - 1; /* Convolutional models take params as input channels */
+        if (model->n_params > 0) {
+            model->paramWeights[0] = param_weights[0];
+            model->paramWeights[1] = param_weights[1];
+            model->paramBias = rnn_bias[0];
+            model->foldedBias = rnn_bias;
+        }
+#endif
+        return model;
+    };
+
+    /* Build the model on the requested backend, or on each one keeping the fastest */
+    const ModelBackend* backends[MAX_MODEL_BACKENDS];
+    int n_backends = 0;
+    if (conv_model) {
+        backends[n_backends++] = &model_backend_conv;
+    }
+    else {
+        for (int i = 0; model_backends[i] != nullptr; i++)
+            backends[n_backends++] = model_backends[i];
+        if (sparse_model)
+            backends[n_backends++] = &model_backend_sparse;
+        if (lowrank_model)
+            backends[n_backends++] = &model_backend_lowrank;
+    }
+    backends[n_backends] = nullptr;
+    bool backend_found = false;
+    for (int i = 0; backends[i] != nullptr; i++) {
+        backend_found |= backends[i]->id == backend;
+    }
+    if (backend != AIDADSP_BACKEND_AUTO && !backend_found) {
+        if (!conv_model)
+            lv2_log_error(logger, "Backend %d not available, picking the fastest\n", backend);
+        backend = AIDADSP_BACKEND_AUTO;
+    }
+
+    DynamicModel* best_model = nullptr;
+    float dense_ns_per_sample = 0.0f; /* Fastest RTNeural backend, to report the speedup of the others */
+
+    for (int i = 0; backends[i] != nullptr; i++) {
+        if (backend != AIDADSP_BACKEND_AUTO && backends[i]->id != backend)
+            continue;
+
+        /* Each backend costs a build and a benchmark, stop as soon as a newer load is queued */
+        if (token.stale()) {
+            lv2_log_trace(logger, "Load of %s superseded\n", name);
+            freeModel(best_model);
+            return nullptr;
+        }
+
+        DynamicModel* model;
+        try {
+            model = newModel(backends[i]);
+            lv2_log_note(logger, "%s %d: mdl rst!\n", __func__, __LINE__);
+        }
+        catch (const std::exception& e) {
+            lv2_log_error(logger, "Error loading model on %s: %s\n", backends[i]->name, e.what());
+            continue;
+        }
+
+        /* Sanity check on inference engine with loaded model, before gains get folded */
+#ifdef DEBUG
+        if (model_json["input_batch"].is_array() && model_json["input_batch"].is_array()) {
+#else
+        if(false) {
+#endif
+            std::vector<float> input_batch = model_json["/input_batch"_json_pointer];
+            std::vector<float> output_batch = model_json["/output_batch"_json_pointer];
+            testModel(logger, model, input_batch, output_batch);
+        }
+
+        try {
+            optimizeModel(logger, model, model_json);
+        }
+        catch (const std::exception& e) {
+            lv2_log_error(logger, "Error optimizing model: %s\n", e.what());
+            freeModel(model);
+            continue;
+        }
+
+        /* Pre-buffer to avoid "clicks" during initialization, then keep the state reached */
+        float out[2048] = {};
+        applyModel(model, out, 2048);
+        model->saveState();
+
+        benchmarkModel(logger, model);
+
+        if (model->backend->id <= AIDADSP_BACKEND_STL && (dense_ns_per_sample == 0.0f || model->ns_per_sample < dense_ns_per_sample))
+            dense_ns_per_sample = model->ns_per_sample;
+
+        if (best_model == nullptr || model->ns_per_sample < best_model->ns_per_sample) {
+            freeModel(best_model);
+            best_model = model;
+        }
+        else {
+            freeModel(model);
+        }
+    }
+
+    if (best_model == nullptr)
+        return nullptr;
+    lv2_log_note(logger, "Model running on %s backend\n", best_model->backend->name);
+    if (best_model->backend->id > AIDADSP_BACKEND_STL && dense_ns_per_sample > 0.0f)
+        lv2_log_note(logger, "%.2fx faster than RTNeural backends\n", dense_ns_per_sample / best_model->ns_per_sample);
+
+    prefaultModel(logger, best_model);
+
+    return best_model;
+}
+
+/**********************************************************************************************************************************************************/
+
+#if AIDADSP_MODEL_LOADER
+/**
+ * This function loads a pre-trained neural model from a json file, or restores it from its cache image
+*/
+DynamicModel* RtNeuralGeneric::loadModelFromPath(LV2_Log_Logger* logger, const char* path, const float old_param1, const float old_param2, int backend, const LoadToken& token)
+{
+    nlohmann::json model_json;
+    std::string cache_path;
+    DynamicModel* model = nullptr;
 
     try {
-        if (! custom_model_creator (model_json, model->variant))
-            throw std::runtime_error ("Unable to identify a known model architecture!");
+        std::ifstream jsonStream(path, std::ifstream::binary);
+        const std::string content((std::istreambuf_iterator<char>(jsonStream)), std::istreambuf_iterator<char>());
+
+        /* Images depend on the backends they have been built on and on how these have been built */
+        std::string cache_salt = AIDADSP_VERSION " " AIDADSP_ISA_NAME " " + std::to_string(AIDADSP_ACTIVATIONS) + " "
+            + std::to_string(AIDADSP_FOLD_PARAMS) + " ";
+        for (int i = 0; model_backends[i] != nullptr; i++)
+            cache_salt += std::string(model_backends[i]->name) + " ";
+        cache_path = modelCachePath(content, cache_salt);
+
+        /* Only the fastest of all backends is cached, a forced one is built from json */
+        ModelCacheImage cache_image;
+        if (backend == AIDADSP_BACKEND_AUTO && !cache_path.empty() && readModelCache(cache_path, cache_image)) {
+            try {
+                model = restoreModel(logger, cache_image.reader(), path, old_param1, old_param2);
+                lv2_log_note(logger, "Successfully restored model from cache: %s\n", path);
+            }
+            catch (const std::exception& e) {
+                lv2_log_warning(logger, "Unable to restore model cache %s\nError: %s\n", cache_path.c_str(), e.what());
+                removeModelCache(cache_path);
+            }
+        }
 
-        std::visit (
-            [&model_json] (auto&& custom_model)
-            {
-                using ModelType = std::decay_t<decltype (custom_model)>;
-                if constexpr (! std::is_same_v<ModelType, NullModel>)
-                {
-                    custom_model.parseJson (model_json, true);
-                    custom_model.reset();
-                }
-            },
-            model->variant);
-        lv2_log_note(logger, "%s %d: mdl rst!\n", __func__, __LINE__);
+        if (model == nullptr) {
+            model_json = nlohmann::json::parse(content);
+            lv2_log_note(logger, "Successfully loaded json file: %s\n", path);
+        }
     }
     catch (const std::exception& e) {
-        lv2_log_error(logger, "Error loading model: %s\n", e.what());
+        lv2_log_error(logger, "Unable to load json file: %s\nError: %s\n", path, e.what());
         return nullptr;
     }
 
-    /* Save extra info */
-    model->path = strdup(path);
-    model->input_skip = input_skip != 0;
-    model->input_gain = input_gain;
-    model->output_gain = output_gain;
-    model->samplerate = model_samplerate;
-#if AIDADSP_CONDITIONED_MODELS
-    model->param1Coeff.setSampleRate(model_samplerate);
-    model->param1Coeff.setTimeConstant(0.1f);
-    model->param1Coeff.setTargetValue(old_param1);
-    model->param1Coeff.clearToTargetValue();
-    model->param2Coeff.setSampleRate(model_samplerate);
-    model->param2Coeff.setTimeConstant(0.1f);
-    model->param2Coeff.setTargetValue(old_param2);
-    model->param2Coeff.clearToTargetValue();
-    model->paramFirstRun = true;
+    if (model == nullptr) {
+        /* Built in place in its arena, see freeModel */
+        model = createModel(logger, model_json, path, old_param1, old_param2, backend, token);
+        if (model == nullptr)
+            return nullptr;
+
+        if (backend == AIDADSP_BACKEND_AUTO && !cache_path.empty()) {
+            try {
+                ModelImage cache_image;
+                serializeModel(model, model_json, cache_image);
+                if (!writeModelCache(cache_path, cache_image))
+                    lv2_log_warning(logger, "Unable to write model cache %s\n", cache_path.c_str());
+            }
+            catch (const std::exception& e) {
+                lv2_log_warning(logger, "Unable to write model cache %s\nError: %s\n", cache_path.c_str(), e.what());
+            }
+        }
+    }
+
+    /* Preload the fallback model for the CPU governor, if there's one next to the model file */
+    std::string fallback_path(path);
+    const size_t extension = fallback_path.rfind(".json");
+    if (extension != std::string::npos && fallback_path.find(FALLBACK_MODEL_SUFFIX) == std::string::npos
+        && std::ifstream(fallback_path.replace(extension, std::string::npos, FALLBACK_MODEL_SUFFIX)).good()) {
+        model->fallback = loadModelFromPath(logger, fallback_path.c_str(), old_param1, old_param2, backend, token);
+        if (model->fallback != nullptr && model->fallback->input_size != model->input_size) {
+            lv2_log_error(logger, "Fallback model input_size %d does not match %d, ignored\n", model->fallback->input_size, model->input_size);
+            freeModel(model->fallback);
+            model->fallback = nullptr;
+        }
+    }
+
+    return model;
+}
 #endif
 
-    /* Sanity check on inference engine with loaded model, also serves as pre-buffer
-    * to avoid "clicks" during initialization */
-#ifdef DEBUG
-    if (model_json["input_batch"].is_array() && model_json["input_batch"].is_array()) {
-#else
-    if(false) {
+#if ! AIDADSP_MODEL_LOADER
+/**
+ * This function builds an embedded model straight from its weights in read-only data, with the
+ * model type and backend picked at build time: the first RTNeural backend compiled in, see
+ * model_backends, so there is neither json nor benchmark. Gains are folded into the engine copy
+ * of the weights. Throws when the model type is not in this build.
+*/
+DynamicModel* RtNeuralGeneric::createEmbeddedModel(LV2_Log_Logger* logger, const EmbeddedEngine& embedded, const char* name, const float old_param1, const float old_param2)
+{
+    if (embedded.n_params > 0 && !AIDADSP_FOLD_PARAMS)
+        throw std::invalid_argument("Params folded when embedding, not in this build");
+
+    const ModelBackend* model_backend = model_backends[0];
+    ModelArena arena(sizeof(DynamicModel));
+    ModelEngine* engine = model_backend->createNamed(embedded.alias, embedded.weights, embedded.n_weights, arena);
+    DynamicModel* model = newModelHeader(std::move(arena), engine, model_backend, name, old_param1, old_param2);
+
+    model->input_skip = embedded.input_skip;
+    model->input_gain = DB_CO(embedded.input_gain_db);
+    model->output_gain = DB_CO(embedded.output_gain_db);
+    model->skip_gain = model->input_gain * model->output_gain;
+    model->samplerate = embedded.samplerate;
+    model->type = embedded.type;
+    model->hidden_size = embedded.hidden_size;
+    model->input_size = embedded.input_size;
+    setModelParamsRate(model);
+
+    /* Recurrent layer weights come first, its input kernel has a row per input left once params are folded */
+    const int gates_size = (model->type == "gru" ? 3 : 4) * model->hidden_size;
+    const int kernel_rows = embedded.input_size - embedded.n_params;
+    const float* kernel = embedded.weights;
+#if AIDADSP_FOLD_PARAMS
+    model->n_params = embedded.n_params;
+    if (model->n_params > 0) {
+        for (int i = 0; i < 2; i++) {
+            if (i < embedded.n_params)
+                model->paramWeights[i].assign(embedded.param_weights + i * gates_size, embedded.param_weights + (i + 1) * gates_size);
+            else
+                model->paramWeights[i].assign(gates_size, 0.0f);
+        }
+        const float* bias = kernel + (kernel_rows + model->hidden_size) * gates_size;
+        model->foldedBias.resize(model->type == "gru" ? 2 : 1);
+        for (std::vector<float>& bias_row : model->foldedBias) {
+            bias_row.assign(bias, bias + gates_size);
+            bias += gates_size;
+        }
+        model->paramBias = model->foldedBias[0];
+    }
 #endif
-        std::vector<float> input_batch = model_json["/input_batch"_json_pointer];
-        std::vector<float> output_batch = model_json["/output_batch"_json_pointer];
-        testModel(logger, model.get(), input_batch, output_batch);
+
+    if (model->input_gain != 1.0f || model->output_gain != 1.0f) {
+        std::vector<std::vector<float>> input_kernel(kernel_rows);
+        for (int i = 0; i < kernel_rows; i++)
+            input_kernel[i].assign(kernel + i * gates_size, kernel + (i + 1) * gates_size);
+        const float* dense = embedded.weights + embedded.n_weights - (embedded.dense_input_size + 1);
+        std::vector<std::vector<float>> dense_kernel(embedded.dense_input_size);
+        for (int i = 0; i < embedded.dense_input_size; i++)
+            dense_kernel[i] = { dense[i] };
+        try {
+            foldModelGains(logger, model, std::move(input_kernel), dense_kernel, { dense[embedded.dense_input_size] });
+        }
+        catch (const std::exception&) {
+            freeModel(model);
+            throw;
+        }
     }
-    else
-    {
-        float out[2048] = {};
-        applyModel(model.get(), out, 2048);
+
+    /* Pre-buffer to avoid "clicks" during initialization, then keep the state reached */
+    float out[2048] = {};
+    applyModel(model, out, 2048);
+    model->saveState();
+
+    lv2_log_note(logger, "Model %s %d input_size %d on %s, built in\n", model->type.c_str(), model->hidden_size, model->input_size, model->backend->name);
+    prefaultModel(logger, model);
+
+    return model;
+}
+
+/**
+ * This function loads one of the models compiled into the plugin, modelIndex counts from 1
+*/
+DynamicModel* RtNeuralGeneric::loadModelFromIndex(LV2_Log_Logger* logger, int modelIndex, const float old_param1, const float old_param2, const LoadToken& token)
+{
+    if (modelIndex < 1 || modelIndex > embeddedModelsCount()) {
+        lv2_log_error(logger, "Model index %d out of %d models\n", modelIndex, embeddedModelsCount());
+        return nullptr;
     }
 
-    // cache input size for later
-    *input_size_ptr = input_size;
+    /* Recurrent models of a model type of this build need no json */
+    if (const EmbeddedEngine* embedded = embeddedModelEngine(modelIndex - 1); embedded != nullptr && model_backends[0] != nullptr) {
+        try {
+            return createEmbeddedModel(logger, *embedded, embeddedModelName(modelIndex - 1), old_param1, old_param2);
+        }
+        catch (const std::exception& e) {
+            lv2_log_warning(logger, "Unable to build embedded model %s on %s, trying its json\nError: %s\n", embeddedModelName(modelIndex - 1), model_backends[0]->name, e.what());
+        }
+    }
 
-    return model.release();
+    nlohmann::json model_json;
+    try {
+        model_json = embeddedModelJson(modelIndex - 1);
+    }
+    catch (const std::exception& e) {
+        lv2_log_error(logger, "Unable to load embedded model: %s\nError: %s\n", embeddedModelName(modelIndex - 1), e.what());
+        return nullptr;
+    }
+
+    return createModel(logger, model_json, embeddedModelName(modelIndex - 1), old_param1, old_param2, AIDADSP_BACKEND_AUTO, token);
+}
+
+#ifdef AIDADSP_CHANNELS
+/**
+ * This function loads the models of all channel switches combinations for a model index control
+ * value, so switching channel needs no load. Combinations leading to the same model share it. The
+ * first model is returned and owns the others.
+*/
+DynamicModel* RtNeuralGeneric::loadChannelModels(LV2_Log_Logger* logger, int modelIndex, const float old_param1, const float old_param2, const LoadToken& token)
+{
+    DynamicModel* models[CHANNEL_COMBINATIONS] = {};
+    int indexes[CHANNEL_COMBINATIONS];
+    std::vector<float> ctrls(8);
+
+    for (int c = 0; c < CHANNEL_COMBINATIONS; c++) {
+        for (int i = 0; i < AIDADSP_CHANNELS; i++)
+            ctrls[i] = (c >> i) & 1 ? 1.0f : 0.0f;
+        indexes[c] = static_cast<int>(controlsToModelIndex(modelIndex, ctrls) + 1.5f); // round to int + 1
+
+        for (int p = 0; p < c && models[c] == nullptr; p++) {
+            if (indexes[p] == indexes[c])
+                models[c] = models[p];
+        }
+        if (models[c] == nullptr)
+            models[c] = loadModelFromIndex(logger, indexes[c], old_param1, old_param2, token);
+        if (models[c] == nullptr) {
+            if (c > 0) {
+                std::copy(models, models + c, models[0]->channel_models);
+                freeModel(models[0]);
+            }
+            return nullptr;
+        }
+    }
+
+    std::copy(models, models + CHANNEL_COMBINATIONS, models[0]->channel_models);
+    return models[0];
 }
 #endif
+#endif
 
 /**********************************************************************************************************************************************************/
 
@@ -1094,9 +2244,23 @@ void RtNeuralGeneric::freeModel(DynamicModel* model)
 {
     if (model == nullptr)
         return;
+    freeModel (model->fallback);
+#ifdef AIDADSP_CHANNELS
+    for (int c = 0; c < CHANNEL_COMBINATIONS; c++) {
+        DynamicModel* channel_model = model->channel_models[c];
+        bool shared = channel_model == model;
+        for (int p = 0; p < c && !shared; p++)
+            shared = model->channel_models[p] == channel_model;
+        if (!shared)
+            freeModel (channel_model);
+    }
+#endif
 #if AIDADSP_MODEL_LOADER
     free (model->path);
 #endif
-    delete model;
+    /* Engine and header are built in place in the arena, which goes last and unlocks its pages, see createModel */
+    ModelArena arena = std::move(model->arena);
+    model->engine->~ModelEngine();
+    model->~DynamicModel();
 }
 
@@ -18,6 +18,11 @@
 #define AIDADSP_CONDITIONED_MODELS 1
 #endif
 
+// conditioning params folded into the recurrent layer bias, follows conditioned models by default
+#ifndef AIDADSP_FOLD_PARAMS
+#define AIDADSP_FOLD_PARAMS AIDADSP_CONDITIONED_MODELS
+#endif
+
 // DC blocker is optional for model loader
 #if AIDADSP_MODEL_LOADER
 #define AIDADSP_OPTIONAL_DCBLOCKER 1
@@ -25,10 +30,57 @@
 #define AIDADSP_OPTIONAL_DCBLOCKER 0
 #endif
 
+// Silence detector threshold and hold time are exposed as controls for model loader
+#if AIDADSP_MODEL_LOADER
+#define AIDADSP_SILENCE_CONTROLS 1
+#else
+#define AIDADSP_SILENCE_CONTROLS 0
+#endif
+
+// model memory is locked once loaded, can be turned off
+#ifndef AIDADSP_MLOCK
+#define AIDADSP_MLOCK 1
+#endif
+
+// ISA level and version the binary has been built for, model cache images depend on them
+#ifndef AIDADSP_ISA_NAME
+#define AIDADSP_ISA_NAME "default"
+#endif
+#ifndef AIDADSP_VERSION
+#define AIDADSP_VERSION "unknown"
+#endif
+
+// Backend override is exposed as a control for model loader
+#if AIDADSP_MODEL_LOADER
+#define AIDADSP_BACKEND_CONTROL 1
+#else
+#define AIDADSP_BACKEND_CONTROL 0
+#endif
+
+// Pipelined model processing on a helper core is exposed as a control for model loader
+#if AIDADSP_MODEL_LOADER
+#define AIDADSP_PIPELINE 1
+#else
+#define AIDADSP_PIPELINE 0
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
 
 #include <lv2/atom/forge.h>
 #include <lv2/atom/util.h>
@@ -40,7 +92,15 @@
 #include <lv2/urid/urid.h>
 #include <lv2/worker/worker.h>
 
-#include <model_variant.hpp>
+#include "activation-tiers.h"
+#if ! AIDADSP_MODEL_LOADER
+#include "embedded-models.h"
+#endif
+#include "loader-pool.h"
+#include "log-ring.h"
+#include "model-cache.h"
+#include "model-engine.h"
+#include "pipeline.h"
 
 #include <Biquad.h>
 #include <ValueSmoother.hpp>
@@ -79,6 +139,11 @@
     #define AIDADSP_PARAMS 2
 #endif
 
+#ifdef AIDADSP_CHANNELS
+    /* Models reachable from the channel switches, one per combination */
+    #define CHANNEL_COMBINATIONS (1 << AIDADSP_CHANNELS)
+#endif
+
 /**********************************************************************************************************************************************************/
 
 typedef enum {
@@ -109,30 +174,72 @@ typedef enum {
 #endif
 #endif
     PLUGIN_ENABLED,
+#if AIDADSP_SILENCE_CONTROLS
+    SILENCE_THR, SILENCE_HOLD,
+#endif
+#if AIDADSP_BACKEND_CONTROL
+    BACKEND,
+#endif
+#if AIDADSP_PIPELINE
+    PIPELINE, LATENCY,
+#endif
     PLUGIN_PORT_COUNT} ports_t;
 
+/* Define cache line size, model weights start on a cache line boundary */
+#define CACHE_LINE_SIZE 64
+
 // Everything needed to run a model
+/* Built in place at the start of its arena, followed by its engine, see createModel */
 struct DynamicModel {
-    ModelVariantType variant;
+    ModelArena arena; /* Storage of the model itself and of its engine */
+    ModelEngine* engine;
+    const ModelBackend* backend; /* Backend the engine has been built with */
+    int requested_backend; /* Backend asked for when loading, AIDADSP_BACKEND_AUTO for the fastest */
 #if AIDADSP_MODEL_LOADER
     char* path;
 #endif
     bool input_skip; /* Means the model has been trained with first input element skipped to the output */
-    float input_gain;
-    float output_gain;
+    float input_gain; /* Folded into model weights by optimizeModel */
+    float output_gain; /* Folded into model weights by optimizeModel */
+    float skip_gain; /* Gain on the input skipped to the output, input_gain * output_gain once folded */
     float samplerate;
 #if AIDADSP_CONDITIONED_MODELS
     LinearValueSmoother param1Coeff;
     LinearValueSmoother param2Coeff;
     bool paramFirstRun;
 #endif
+#if AIDADSP_FOLD_PARAMS
+    int n_params; /* Conditioning params folded into the recurrent layer bias, 0 for snapshot models */
+    std::vector<float> paramWeights[2]; /* Input weights of param1 and param2 */
+    std::vector<float> paramBias; /* Input bias of the recurrent layer as found in the model */
+    std::vector<std::vector<float>> foldedBias; /* Bias with params folded, laid out as expected by setBVals */
+    float foldedParam1;
+    float foldedParam2;
+#endif
+
+    DynamicModel* fallback; /* Smaller model to switch to under DSP overload, nullptr if none */
+#ifdef AIDADSP_CHANNELS
+    DynamicModel* channel_models[CHANNEL_COMBINATIONS]; /* Indexed by channel switches bits, owned by the first one, nullptr in the others */
+#endif
+    std::string type; /* First layer type, as found in the model file */
+    int hidden_size;
+    int input_size; /* Before params folding */
+    float ns_per_sample; /* Measured by benchmarkModel, or read back from the cache image */
+    size_t memory_size; /* Bytes taken by the model and its engine */
+    bool locked; /* Model memory has been locked by prefaultModel */
+    uint32_t generation; /* Load that built the model, see scheduleLoad */
+
+    void saveState();
+    void restoreState();
 };
 
 #define PROCESS_ATOM_MESSAGES
 enum WorkerMessageType {
     kWorkerLoad,
     kWorkerApply,
-    kWorkerFree
+    kWorkerFree,
+    kWorkerLog,
+    kWorkerPipeline
 };
 
 // common fields to all worker messages
@@ -146,14 +253,31 @@ struct WorkerLoadMessage {
 #if AIDADSP_MODEL_LOADER
     char path[1024];
 #else
-    int modelIndex;
+    int modelIndex; /* From 1, or model index control value for channel models */
 #endif
+    int backend;
+    uint32_t generation; /* Loads superseded by a newer one are skipped or aborted */
 };
 
 // WorkerMessage compatible, to be used for kWorkerApply or kWorkerFree
 struct WorkerApplyMessage {
     WorkerMessageType type;
     DynamicModel* model;
+    uint32_t generation; /* Generation of the load, kWorkerApply only */
+};
+
+// WorkerMessage compatible, to be used for kWorkerPipeline
+struct WorkerPipelineMessage {
+    WorkerMessageType type;
+    bool available; /* Reply only, false when the helper can't run */
+};
+
+// Tells a load in the worker whether a newer one has been scheduled since
+struct LoadToken {
+    const std::atomic<uint32_t>* latest;
+    uint32_t generation;
+
+    bool stale() const { return latest != nullptr && latest->load(std::memory_order_acquire) != generation; }
 };
 
 /* Convert a value in dB's to a coefficent */
@@ -173,13 +297,54 @@ struct WorkerApplyMessage {
 #define DEPTH_Q 0.707f
 #define PRESENCE_FREQ 900.0f
 #define PRESENCE_Q 0.707f
+#define TONE_BAND_DEPTH (1 << 0) /* Bits of tone_skipped */
+#define TONE_BAND_BASS (1 << 1)
+#define TONE_BAND_MID (1 << 2)
+#define TONE_BAND_TREBLE (1 << 3)
+#define TONE_BAND_PRESENCE (1 << 4)
 
 /* Defines for antialiasing filter */
 #define INLPF_MAX_CO 0.99f * 0.5f /* coeff * ((samplerate / 2) / samplerate) */
 #define INLPF_MIN_CO 0.25f * 0.5f /* coeff * ((samplerate / 2) / samplerate) */
 
-/* Define the acceptable threshold for model test */
-#define TEST_MODEL_THR 1.0e-5
+/* Define how often the folded bias follows params smoothers while they are ramping */
+#define PARAM_FOLD_BLOCK 16
+
+/* Defines for silence detector, used when not exposed as controls */
+#define SILENCE_THR_DB -80.0f /* Input peak below this level is silence, -90 dB or below disables the detector */
+#define SILENCE_HOLD_MS 1000.0f /* Time the input must stay silent before the model is idled */
+
+/* Defines for the CPU governor, loads are the share of the period deadline spent in run */
+#define GOVERNOR_TIER_FULL 0 /* Everything runs */
+#define GOVERNOR_TIER_EQ 1 /* Flat eq bands are skipped */
+#define GOVERNOR_TIER_FALLBACK 2 /* Fallback model runs in place of the loaded one */
+#define GOVERNOR_LOAD_HIGH 0.5f /* Step down above this load */
+#define GOVERNOR_LOAD_LOW 0.2f /* Step up below this load */
+#define GOVERNOR_TIME_CONSTANT 0.5f /* Seconds, moving average of the load */
+#define GOVERNOR_HOLD_DOWN 0.5f /* Seconds between two steps down */
+#define GOVERNOR_HOLD_UP 10.0f /* Seconds of low load before stepping up */
+
+/* Crossfade between the models of two channels */
+#define CHANNEL_FADE_SAMPLES 256
+
+/* Suffix of the fallback model file, next to the model file */
+#define FALLBACK_MODEL_SUFFIX "_fallback.json"
+
+/* Regions at least this big are asked to be backed by transparent huge pages */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* Defines for load time model benchmark, best of runs is kept */
+#define BENCHMARK_SAMPLES 4096
+#define BENCHMARK_RUNS 3
+
+/* Define the acceptable threshold for model test, depends on the activations accuracy tier */
+#if AIDADSP_ACTIVATIONS == AIDADSP_ACTIVATIONS_PADE
+#define TEST_MODEL_THR AIDADSP_ACTIVATIONS_PADE_THR
+#elif AIDADSP_ACTIVATIONS == AIDADSP_ACTIVATIONS_POLY
+#define TEST_MODEL_THR AIDADSP_ACTIVATIONS_POLY_THR
+#else
+#define TEST_MODEL_THR AIDADSP_ACTIVATIONS_EXACT_THR
+#endif
 
 /**********************************************************************************************************************************************************/
 
@@ -237,14 +402,51 @@ public:
     float *eq_bypass;
     float *input_size;
     float *enabled;
-
-    // to be used for reporting input_size to GUI (0 for error/unloaded, otherwise matching input_size)
+#if AIDADSP_SILENCE_CONTROLS
+    float *silence_thr_db;
+    float *silence_hold_ms;
+#endif
+#if AIDADSP_BACKEND_CONTROL
+    float *backend_port;
+#endif
+#if AIDADSP_PIPELINE
+    float *pipeline_port;
+    float *latency_port;
+    ModelPipeline pipeline;
+    bool pipeline_failed; /* Helper missed a deadline, stays inline until the control is turned off */
+    bool pipeline_unavailable; /* Helper can't run, e.g. on a single core */
+    bool pipeline_wake_pending; /* Worker asked to start or wake the helper */
+    float pipeline_load; /* Helper time on the last block it ran over the period, see updateGovernor */
+    bool pipeline_late; /* Block in flight past its deadline, the dry input passes meanwhile */
+    PipelineBlock* pipeline_last; /* Block delivered on last run, faded out on a missed deadline */
+    int pipeline_host_cpu; /* Audio thread core and thread, sampled when the mode is turned on */
+    pthread_t pipeline_host_thread;
+#endif
+    int forced_backend; /* Backend the user asked for, AIDADSP_BACKEND_AUTO for the fastest */
+    std::atomic<uint32_t> load_generation; /* Generation of the last load scheduled */
+    std::atomic<DynamicModel*> loaded_model; /* Left by the loader pool, collected by run */
+    std::atomic<int> loads_in_flight; /* Loads of this instance in the loader pool */
+    std::mutex loaded_model_mutex; /* Loader pool threads only */
+    uint32_t silence_samples; /* Consecutive samples below silence threshold, saturates at hold time */
+    bool model_idle; /* Model is idled on silence, output holds idle_output */
+    float idle_output;
+    bool model_restart; /* Model switched, start it from its warm state on next run */
+    /* CPU governor */
+    int governor_tier;
+    float governor_load; /* Moving average of the load */
+    float governor_hold; /* Seconds spent in current tier */
+
+    // to be used for reporting input_size to GUI (0 for error/unloaded, otherwise matching input_size), audio thread only
     int last_input_size;
 #if ! AIDADSP_MODEL_LOADER
     float *model_index;
     float model_index_old;
 #ifdef AIDADSP_CHANNELS
     std::vector<float*> channel_switch;
+    int channel; /* Channel switches as bits, selects the model in model->channel_models */
+    DynamicModel* channel_fade_model; /* Model of the previous channel while it fades out */
+    uint32_t channel_fade_pos;
+    float channel_fade[CHANNEL_FADE_SAMPLES];
 #endif
 #endif
 
@@ -268,12 +470,29 @@ public:
                                        const void*                 data);
     static LV2_Worker_Status work_response(LV2_Handle instance, uint32_t size, const void* data);
 #if AIDADSP_MODEL_LOADER
-    static DynamicModel* loadModelFromPath(LV2_Log_Logger* logger, const char* path, int* input_size_ptr, const float old_param1, const float old_param2);
+    static DynamicModel* loadModelFromPath(LV2_Log_Logger* logger, const char* path, const float old_param1, const float old_param2, int backend, const LoadToken& token);
+    static void serializeModel(const DynamicModel* model, const nlohmann::json& model_json, ModelImage& image);
+    static DynamicModel* restoreModel(LV2_Log_Logger* logger, ModelImageReader image, const char* name, const float old_param1, const float old_param2);
 #else
-    static DynamicModel* loadModelFromIndex(LV2_Log_Logger* logger, int modelIndex, int* input_size_ptr, const float old_param1, const float old_param2);
+    static DynamicModel* loadModelFromIndex(LV2_Log_Logger* logger, int modelIndex, const float old_param1, const float old_param2, const LoadToken& token);
     static float controlsToModelIndex(int modelIndex, const std::vector<float>& ctrls);
+    static DynamicModel* createEmbeddedModel(LV2_Log_Logger* logger, const EmbeddedEngine& embedded, const char* name, const float old_param1, const float old_param2);
+#ifdef AIDADSP_CHANNELS
+    static DynamicModel* loadChannelModels(LV2_Log_Logger* logger, int modelIndex, const float old_param1, const float old_param2, const LoadToken& token);
+#endif
 #endif
+    static DynamicModel* createModel(LV2_Log_Logger* logger, nlohmann::json& model_json, const char* name, const float old_param1, const float old_param2, int backend, const LoadToken& token);
+    static void optimizeModel(LV2_Log_Logger* logger, DynamicModel* model, const nlohmann::json& model_json);
+    static void foldModelGains(LV2_Log_Logger* logger, DynamicModel* model, std::vector<std::vector<float>> kernel, const std::vector<std::vector<float>>& dense_kernel, std::vector<float> dense_bias);
+    static void benchmarkModel(LV2_Log_Logger* logger, DynamicModel* model);
+    static void prefaultModel(LV2_Log_Logger* logger, DynamicModel* model);
     static void freeModel(DynamicModel* model);
+    static void scheduleLoad(RtNeuralGeneric* self, WorkerLoadMessage& msg);
+    static void requestLogFlush(RtNeuralGeneric* self);
+#if AIDADSP_PIPELINE
+    static void requestPipelineWake(RtNeuralGeneric* self);
+#endif
+    static void loadModel(RtNeuralGeneric* self, const WorkerLoadMessage& msg, const LoadToken& token, float param1, float param2);
 
     // Features
     LV2_URID_Map*        map;
@@ -290,6 +509,7 @@ public:
 
     // Logger convenience API
     LV2_Log_Logger logger;
+    LogRing log_ring; /* Log of the audio thread, written by the worker */
 
     // Ports
 #if AIDADSP_MODEL_LOADER
@@ -315,11 +535,28 @@ private:
     Biquad *treble;
     Biquad *depth;
     Biquad *presence;
+    uint8_t tone_skipped; /* Tone bands skipped since they last ran, see applyToneBand */
 
     DynamicModel* model;
 
     static void applyBiquadFilter(float *out, const float *in, Biquad *filter, uint32_t n_samples);
+    static void applyToneBand(float *out, Biquad *filter, uint8_t band, bool active, uint8_t& skipped, uint32_t n_samples);
     static void applyModel(DynamicModel *model, float *out, uint32_t n_samples);
+    static void applyModelOrIdle(float *out, DynamicModel *model, LV2_Handle instance, uint32_t n_samples);
+    static void applyModelInline(float *out, DynamicModel *model, float param1, float param2, LV2_Handle instance, uint32_t n_samples);
+    static void restartModel(DynamicModel *model, LV2_Handle instance);
+#ifdef AIDADSP_CHANNELS
+    static void applyChannelFade(float *out, const float *from, LV2_Handle instance, uint32_t n_samples);
+#endif
+#if AIDADSP_CONDITIONED_MODELS
+    static void setModelParams(DynamicModel *model, float param1, float param2);
+#endif
+#if AIDADSP_PIPELINE
+    static bool applyModelPipelined(float *out, DynamicModel *model, float param1, float param2, LV2_Handle instance, uint32_t n_samples, bool pipelined);
+    static void processPipelineBlock(void* instance, PipelineBlock& block);
+    static void applyCrossfade(float *out, const float *from, uint32_t n_samples, uint32_t n_from);
+#endif
+    static void updateGovernor(LV2_Handle instance, std::chrono::steady_clock::time_point start, uint32_t n_samples);
     static void applyToneControls(float *out, const float *in, LV2_Handle instance, uint32_t n_samples);
     static bool testModel(LV2_Log_Logger* logger, DynamicModel *model, const std::vector<float>& xData, const std::vector<float>& yData);
 };
@@ -29,16 +29,40 @@
 
 #define PLUGIN__json PLUGIN_URI "#json"
 #define PLUGIN__applyJson PLUGIN_URI "#applyJson"
+#define PLUGIN__governorTier PLUGIN_URI "#governorTier"
+#define PLUGIN__modelCost PLUGIN_URI "#modelCost"
+#define PLUGIN__modelType PLUGIN_URI "#modelType"
+#define PLUGIN__modelBackend PLUGIN_URI "#modelBackend"
+#define PLUGIN__modelHiddenSize PLUGIN_URI "#modelHiddenSize"
+#define PLUGIN__modelInputSize PLUGIN_URI "#modelInputSize"
+#define PLUGIN__nsPerSample PLUGIN_URI "#nsPerSample"
+#define PLUGIN__dspLoad PLUGIN_URI "#dspLoad"
+#define PLUGIN__modelMemory PLUGIN_URI "#modelMemory"
+#define PLUGIN__modelLocked PLUGIN_URI "#modelLocked"
 
 typedef struct {
+    LV2_URID atom_Bool;
     LV2_URID atom_Float;
+    LV2_URID atom_Int;
+    LV2_URID atom_Object;
     LV2_URID atom_Path;
     LV2_URID atom_Resource;
     LV2_URID atom_Sequence;
+    LV2_URID atom_String;
     LV2_URID atom_URID;
     LV2_URID atom_eventTransfer;
     LV2_URID applyJson;
+    LV2_URID governorTier;
     LV2_URID json;
+    LV2_URID modelCost;
+    LV2_URID modelType;
+    LV2_URID modelBackend;
+    LV2_URID modelHiddenSize;
+    LV2_URID modelInputSize;
+    LV2_URID nsPerSample;
+    LV2_URID dspLoad;
+    LV2_URID modelMemory;
+    LV2_URID modelLocked;
     LV2_URID midi_Event;
     LV2_URID param_gain;
     LV2_URID patch_Get;
@@ -50,14 +74,28 @@ typedef struct {
 static inline void
 map_plugin_uris(LV2_URID_Map* map, PluginURIs* uris)
 {
+    uris->atom_Bool                = map->map(map->handle, LV2_ATOM__Bool);
     uris->atom_Float               = map->map(map->handle, LV2_ATOM__Float);
+    uris->atom_Int                 = map->map(map->handle, LV2_ATOM__Int);
+    uris->atom_Object              = map->map(map->handle, LV2_ATOM__Object);
     uris->atom_Path                = map->map(map->handle, LV2_ATOM__Path);
     uris->atom_Resource            = map->map(map->handle, LV2_ATOM__Resource);
     uris->atom_Sequence            = map->map(map->handle, LV2_ATOM__Sequence);
+    uris->atom_String              = map->map(map->handle, LV2_ATOM__String);
     uris->atom_URID                = map->map(map->handle, LV2_ATOM__URID);
     uris->atom_eventTransfer       = map->map(map->handle, LV2_ATOM__eventTransfer);
     uris->applyJson                = map->map(map->handle, PLUGIN__applyJson);
+    uris->governorTier             = map->map(map->handle, PLUGIN__governorTier);
     uris->json                     = map->map(map->handle, PLUGIN__json);
+    uris->modelCost                = map->map(map->handle, PLUGIN__modelCost);
+    uris->modelType                = map->map(map->handle, PLUGIN__modelType);
+    uris->modelBackend             = map->map(map->handle, PLUGIN__modelBackend);
+    uris->modelHiddenSize          = map->map(map->handle, PLUGIN__modelHiddenSize);
+    uris->modelInputSize           = map->map(map->handle, PLUGIN__modelInputSize);
+    uris->nsPerSample              = map->map(map->handle, PLUGIN__nsPerSample);
+    uris->dspLoad                  = map->map(map->handle, PLUGIN__dspLoad);
+    uris->modelMemory              = map->map(map->handle, PLUGIN__modelMemory);
+    uris->modelLocked              = map->map(map->handle, PLUGIN__modelLocked);
     uris->midi_Event               = map->map(map->handle, LV2_MIDI__MidiEvent);
     uris->param_gain               = map->map(map->handle, LV2_PARAMETERS__gain);
     uris->patch_Get                = map->map(map->handle, LV2_PATCH__Get);
@@ -92,3 +130,92 @@ write_set_file(LV2_Atom_Forge*    forge,
 
     return set;
 }
+
+/**
+ * Write a message like the following to @p forge:
+ * []
+ *     a patch:Set ;
+ *     patch:property eg:modelCost ;
+ *     patch:value [
+ *         a eg:modelCost ;
+ *         eg:modelType "lstm" ;
+ *         eg:modelBackend "xsimd" ;
+ *         eg:modelHiddenSize 12 ;
+ *         eg:modelInputSize 1 ;
+ *         eg:nsPerSample 850.0 ;
+ *         eg:dspLoad 4.08 ;
+ *         eg:modelMemory 40960 ;
+ *         eg:modelLocked true ;
+ *     ] .
+ */
+static inline LV2_Atom*
+write_set_cost(LV2_Atom_Forge*    forge,
+               const PluginURIs* uris,
+               const char*        type,
+               const char*        backend,
+               const int32_t      hidden_size,
+               const int32_t      input_size,
+               const float        ns_per_sample,
+               const float        dsp_load,
+               const int32_t      memory_size,
+               const bool         locked)
+{
+    LV2_Atom_Forge_Frame frame;
+    LV2_Atom* set = (LV2_Atom*)lv2_atom_forge_object(
+                forge, &frame, 0, uris->patch_Set);
+
+    lv2_atom_forge_key(forge, uris->patch_property);
+    lv2_atom_forge_urid(forge, uris->modelCost);
+    lv2_atom_forge_key(forge, uris->patch_value);
+
+    LV2_Atom_Forge_Frame value_frame;
+    lv2_atom_forge_object(forge, &value_frame, 0, uris->modelCost);
+    lv2_atom_forge_key(forge, uris->modelType);
+    lv2_atom_forge_string(forge, type, strlen(type));
+    lv2_atom_forge_key(forge, uris->modelBackend);
+    lv2_atom_forge_string(forge, backend, strlen(backend));
+    lv2_atom_forge_key(forge, uris->modelHiddenSize);
+    lv2_atom_forge_int(forge, hidden_size);
+    lv2_atom_forge_key(forge, uris->modelInputSize);
+    lv2_atom_forge_int(forge, input_size);
+    lv2_atom_forge_key(forge, uris->nsPerSample);
+    lv2_atom_forge_float(forge, ns_per_sample);
+    lv2_atom_forge_key(forge, uris->dspLoad);
+    lv2_atom_forge_float(forge, dsp_load);
+    lv2_atom_forge_key(forge, uris->modelMemory);
+    lv2_atom_forge_int(forge, memory_size);
+    lv2_atom_forge_key(forge, uris->modelLocked);
+    lv2_atom_forge_bool(forge, locked);
+    lv2_atom_forge_pop(forge, &value_frame);
+
+    lv2_atom_forge_pop(forge, &frame);
+
+    return set;
+}
+
+/**
+ * Write a message like the following to @p forge:
+ * []
+ *     a patch:Set ;
+ *     patch:property eg:governorTier ;
+ *     patch:value 1 .
+ */
+static inline LV2_Atom*
+write_set_int(LV2_Atom_Forge*    forge,
+              const PluginURIs* uris,
+              const LV2_URID     property,
+              const int32_t      value)
+{
+    LV2_Atom_Forge_Frame frame;
+    LV2_Atom* set = (LV2_Atom*)lv2_atom_forge_object(
+                forge, &frame, 0, uris->patch_Set);
+
+    lv2_atom_forge_key(forge, uris->patch_property);
+    lv2_atom_forge_urid(forge, property);
+    lv2_atom_forge_key(forge, uris->patch_value);
+    lv2_atom_forge_int(forge, value);
+
+    lv2_atom_forge_pop(forge, &frame);
+
+    return set;
+}
@@ -0,0 +1,136 @@
+/*
+ * aidadsp-lv2
+ * Copyright (C) 2022-2023 Massimo Pennazio <maxipenna@libero.it>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * RTNeural backends of a plugin built with AIDADSP_VARIANT_MODULES. Model types of each variant
+ * family (see variant/generate_variant_hpp.py) are compiled once per backend into a module of their
+ * own, next to the plugin binary, and a module is only loaded the first time a model of its family
+ * gets built. The plugin binary carries no RTNeural model code, so the host maps and relocates the
+ * code of the architectures in use only. Called from loader threads, nothing here is realtime safe.
+ */
+
+#include <dlfcn.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <model_families.hpp>
+
+#include "model-engine.h"
+
+namespace {
+
+/* Exported by each module, see model-engine.cpp */
+#define VARIANT_MODULE_SYMBOL "aidadsp_variant_module"
+
+/* Set for backends built once for all ISA levels with AIDADSP_ISA_DISPATCH, see CMakeLists.txt */
+#ifndef AIDADSP_SHARED_XSIMD
+#define AIDADSP_SHARED_XSIMD 0
+#endif
+#ifndef AIDADSP_SHARED_EIGEN
+#define AIDADSP_SHARED_EIGEN 0
+#endif
+#ifndef AIDADSP_SHARED_STL
+#define AIDADSP_SHARED_STL 0
+#endif
+
+/**
+ * Modules are named after the plugin binary, its backend and family, see CMakeLists.txt. Shared
+ * modules are named after the plugin binary without its ISA level suffix.
+ */
+std::string modulePath(int backend, const char* backend_name, int family)
+{
+    Dl_info info;
+    if (!dladdr((void*)&modulePath, &info) || info.dli_fname == nullptr)
+        throw std::runtime_error ("Unable to locate plugin binary!");
+
+    std::string path(info.dli_fname);
+    const size_t extension = path.rfind(".so");
+    if (extension != std::string::npos)
+        path.erase(extension);
+#ifdef AIDADSP_ISA_NAME
+    static const bool shared[AIDADSP_BACKEND_STL + 1] = { false, AIDADSP_SHARED_XSIMD, AIDADSP_SHARED_EIGEN, AIDADSP_SHARED_STL };
+    const std::string isa_suffix = "_" AIDADSP_ISA_NAME;
+    if (shared[backend] && path.size() > isa_suffix.size() && path.compare(path.size() - isa_suffix.size(), isa_suffix.size(), isa_suffix) == 0)
+        path.erase(path.size() - isa_suffix.size());
+#else
+    (void) backend;
+#endif
+    return path + "-" + backend_name + "-" + model_family_names[family] + ".so";
+}
+
+const ModelBackend* loadModule(int backend, const char* backend_name, int family)
+{
+    static std::mutex mutex;
+    static const ModelBackend* modules[AIDADSP_BACKEND_STL + 1][MODEL_FAMILIES_COUNT] = {};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (modules[backend][family] == nullptr) {
+        const std::string path = modulePath(backend, backend_name, family);
+        // never closed, engines built by the module run its code until the plugin is unloaded
+        void* lib = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (lib == nullptr)
+            throw std::runtime_error (std::string("Unable to load variant module: ") + dlerror());
+
+        const ModelBackend* module = (const ModelBackend*) dlsym(lib, VARIANT_MODULE_SYMBOL);
+        if (module == nullptr || module->id != backend)
+            throw std::runtime_error ("Invalid variant module " + path);
+        modules[backend][family] = module;
+    }
+    return modules[backend][family];
+}
+
+ModelEngine* createEngine(int backend, const char* backend_name, const nlohmann::json& model_json, ModelArena& arena)
+{
+    const int family = model_family(model_json);
+    if (family < 0)
+        throw std::runtime_error (MODEL_VARIANT_UNSUPPORTED);
+
+    return loadModule(backend, backend_name, family)->create(model_json, arena);
+}
+
+/* Images start with the name of the model type, the module of its family restores it */
+ModelEngine* restoreEngine(int backend, const char* backend_name, ModelImageReader& image, ModelArena& arena)
+{
+    ModelImageReader peek = image;
+    const int family = model_alias_family(peek.getString());
+    if (family < 0)
+        throw std::runtime_error (MODEL_VARIANT_UNSUPPORTED);
+
+    return loadModule(backend, backend_name, family)->restore(image, arena);
+}
+
+/* Same on the name of the model type */
+ModelEngine* createNamedEngine(int backend, const char* backend_name, const char* alias, const float* weights, size_t n_weights, ModelArena& arena)
+{
+    const int family = model_alias_family(alias);
+    if (family < 0)
+        throw std::runtime_error (MODEL_VARIANT_UNSUPPORTED);
+
+    return loadModule(backend, backend_name, family)->createNamed(alias, weights, n_weights, arena);
+}
+
+} // namespace
+
+#if AIDADSP_WITH_XSIMD
+const ModelBackend model_backend_xsimd = { AIDADSP_BACKEND_XSIMD, "xsimd",
+    [] (const nlohmann::json& model_json, ModelArena& arena) { return createEngine(AIDADSP_BACKEND_XSIMD, "xsimd", model_json, arena); },
+    [] (ModelImageReader& image, ModelArena& arena) { return restoreEngine(AIDADSP_BACKEND_XSIMD, "xsimd", image, arena); },
+    [] (const char* alias, const float* weights, size_t n_weights, ModelArena& arena) { return createNamedEngine(AIDADSP_BACKEND_XSIMD, "xsimd", alias, weights, n_weights, arena); } };
+#endif
+#if AIDADSP_WITH_EIGEN
+const ModelBackend model_backend_eigen = { AIDADSP_BACKEND_EIGEN, "eigen",
+    [] (const nlohmann::json& model_json, ModelArena& arena) { return createEngine(AIDADSP_BACKEND_EIGEN, "eigen", model_json, arena); },
+    [] (ModelImageReader& image, ModelArena& arena) { return restoreEngine(AIDADSP_BACKEND_EIGEN, "eigen", image, arena); },
+    [] (const char* alias, const float* weights, size_t n_weights, ModelArena& arena) { return createNamedEngine(AIDADSP_BACKEND_EIGEN, "eigen", alias, weights, n_weights, arena); } };
+#endif
+#if AIDADSP_WITH_STL
+const ModelBackend model_backend_stl = { AIDADSP_BACKEND_STL, "stl",
+    [] (const nlohmann::json& model_json, ModelArena& arena) { return createEngine(AIDADSP_BACKEND_STL, "stl", model_json, arena); },
+    [] (ModelImageReader& image, ModelArena& arena) { return restoreEngine(AIDADSP_BACKEND_STL, "stl", image, arena); },
+    [] (const char* alias, const float* weights, size_t n_weights, ModelArena& arena) { return createNamedEngine(AIDADSP_BACKEND_STL, "stl", alias, weights, n_weights, arena); } };
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#include <RTNeural/RTNeural.h>
+
+#include <activations.hpp>
+
+#ifndef AIDADSP_MODELS_DIR
+#define AIDADSP_MODELS_DIR "../models"
+#endif
+
+using namespace std;
+
+template <typename MathsProvider, int hidden_size>
+using LSTMModel = RTNeural::ModelT<float, 1, 1,
+    RTNeural::LSTMLayerT<float, 1, hidden_size, RTNeural::SampleRateCorrectionMode::None, MathsProvider>,
+    RTNeural::DenseT<float, hidden_size, 1>>;
+
+template <typename MathsProvider, int hidden_size>
+using GRUModel = RTNeural::ModelT<float, 1, 1,
+    RTNeural::GRULayerT<float, 1, hidden_size, RTNeural::SampleRateCorrectionMode::None, MathsProvider>,
+    RTNeural::DenseT<float, hidden_size, 1>>;
+
+using HiddenSizes = std::integer_sequence<int, 8, 12, 16, 20, 24, 32, 40, 64, 80>;
+
+/* Run input_batch through the model and return max abs error against output_batch */
+template <typename ModelType>
+static float runModel(const nlohmann::json& modelData) {
+    std::unique_ptr<ModelType> model = std::make_unique<ModelType>();
+    model->parseJson(modelData, false);
+    model->reset();
+
+    const std::vector<float> xData = modelData["input_batch"];
+    const std::vector<float> yData = modelData["output_batch"];
+    float max_error = 0.0f;
+    for (size_t i = 0; i < xData.size(); i++) {
+        float in alignas(RTNEURAL_DEFAULT_ALIGNMENT)[1] = { xData[i] };
+        float out = model->forward(in);
+        if (modelData["in_skip"].is_number() && modelData["in_skip"].get<int>() == 1)
+            out += xData[i];
+        max_error = std::max(std::abs(out - yData[i]), max_error);
+    }
+    return max_error;
+}
+
+template <typename MathsProvider, int... hidden_sizes>
+static float runTier(const nlohmann::json& modelData, const std::string& type, int hidden_size, std::integer_sequence<int, hidden_sizes...>) {
+    float max_error = -1.0f;
+    ((hidden_size == hidden_sizes ? (max_error = (type == "lstm")
+        ? runModel<LSTMModel<MathsProvider, hidden_sizes>>(modelData)
+        : runModel<GRUModel<MathsProvider, hidden_sizes>>(modelData)) : 0.0f), ...);
+    return max_error;
+}
+
+template <typename MathsProvider>
+static bool testTier(const char* name, const nlohmann::json& modelData, const std::string& type, int hidden_size) {
+    float max_error = runTier<MathsProvider>(modelData, type, hidden_size, HiddenSizes{});
+    if (max_error < 0.0f) {
+        std::cout << "  " << name << ": architecture not covered, skipped" << std::endl;
+        return true;
+    }
+    bool success = max_error <= MathsProvider::test_threshold;
+    printf("  %s: max err %.12f, thr: %.12f %s\n", name, max_error, MathsProvider::test_threshold, success ? "OK" : "FAIL");
+    return success;
+}
+
+int main(void) {
+    int failures = 0;
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(AIDADSP_MODELS_DIR)) {
+        if (entry.path().extension() != ".json")
+            continue;
+
+        std::cout << "Testing json file: " << entry.path().string() << std::endl;
+
+        try {
+            std::ifstream jsonStream(entry.path(), std::ifstream::binary);
+            nlohmann::json modelData;
+            jsonStream >> modelData;
+
+            if (modelData["in_shape"].back().get<int>() != 1 || !modelData["input_batch"].is_array()) {
+                std::cout << "  conditioned or without input_batch, skipped" << std::endl;
+                continue;
+            }
+
+            const std::string type = modelData["layers"][0]["type"];
+            const int hidden_size = modelData["layers"][0]["shape"].back().get<int>();
+
+            failures += !testTier<RTNeural::ExactMathsProvider>("EXACT", modelData, type, hidden_size);
+            failures += !testTier<RTNeural::PadeMathsProvider>("PADE", modelData, type, hidden_size);
+            failures += !testTier<RTNeural::PolyMathsProvider>("POLY", modelData, type, hidden_size);
+        }
+        catch (const std::exception& e) {
+            std::cout << std::endl << "Unable to load json file: " << entry.path().string() << std::endl;
+            std::cout << e.what() << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
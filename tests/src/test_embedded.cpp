@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <embedded-models.h>
+
+#ifndef AIDADSP_MODELS_DIR
+#define AIDADSP_MODELS_DIR "../models"
+#endif
+
+/* Embedded numbers are floats, anything else must match exactly. Path of first mismatch in where */
+static bool sameJson(const nlohmann::json& file, const nlohmann::json& embedded, std::string& where) {
+    if (file.is_number() && embedded.is_number()) {
+        if (static_cast<float>(file.get<double>()) == static_cast<float>(embedded.get<double>()))
+            return true;
+    }
+    else if (file.is_array() && embedded.is_array() && file.size() == embedded.size()) {
+        for (size_t i = 0; i < file.size(); i++) {
+            if (!sameJson(file[i], embedded[i], where)) {
+                where = "/" + std::to_string(i) + where;
+                return false;
+            }
+        }
+        return true;
+    }
+    else if (file.is_object() && embedded.is_object() && file.size() == embedded.size()) {
+        for (const auto& item : file.items()) {
+            if (!embedded.contains(item.key()) || !sameJson(item.value(), embedded.at(item.key()), where)) {
+                where = "/" + item.key() + where;
+                return false;
+            }
+        }
+        return true;
+    }
+    else if (!file.is_structured() && !file.is_number()) {
+        if (file == embedded)
+            return true;
+    }
+    where = ": " + file.dump().substr(0, 40) + " vs " + embedded.dump().substr(0, 40);
+    return false;
+}
+
+/* Numbers of a json array, depth first, as floats */
+static void flatten(const nlohmann::json& values, std::vector<float>& flat) {
+    if (values.is_array()) {
+        for (const nlohmann::json& value : values)
+            flatten(value, flat);
+    }
+    else {
+        flat.push_back(values.get<float>());
+    }
+}
+
+/**
+ * Models built with no json must carry the layer weights of the file in order, but for the params
+ * input rows of the first kernel which go apart, see EmbeddedEngine.
+ */
+static bool sameEngine(const nlohmann::json& file, const EmbeddedEngine& engine, std::string& where) {
+    std::vector<float> weights;
+    std::vector<float> param_weights;
+    const nlohmann::json& json_layers = file.at("layers");
+    for (size_t l = 0; l < json_layers.size(); l++) {
+        const nlohmann::json& tensors = json_layers[l].at("weights");
+        for (size_t t = 0; t < tensors.size(); t++) {
+            if (l == 0 && t == 0 && engine.n_params > 0) {
+                flatten(tensors[0][0], weights);
+                for (int p = 1; p <= engine.n_params; p++)
+                    flatten(tensors[0][p], param_weights);
+            }
+            else {
+                flatten(tensors[t], weights);
+            }
+        }
+    }
+
+    if (engine.type != json_layers[0].at("type").get<std::string>() || engine.hidden_size != json_layers[0].at("shape").back().get<int>()
+        || engine.input_size != file.at("in_shape").back().get<int>())
+        where = ": layer type or size";
+    else if (weights.size() != engine.n_weights || !std::equal(weights.begin(), weights.end(), engine.weights))
+        where = ": layer weights";
+    else if (engine.n_params > 0 && !std::equal(param_weights.begin(), param_weights.end(), engine.param_weights))
+        where = ": params weights";
+    else
+        return true;
+    return false;
+}
+
+int main(void) {
+    int failures = 0;
+
+    /* Models are embedded from the same directory, they are told apart by their file name */
+    std::map<std::string, std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(AIDADSP_MODELS_DIR)) {
+        if (entry.path().extension() == ".json")
+            files[entry.path().stem().string()] = entry.path();
+    }
+
+    if (embeddedModelsCount() != static_cast<int>(files.size())) {
+        std::cout << embeddedModelsCount() << " models embedded out of " << files.size() << " json files" << std::endl;
+        failures++;
+    }
+
+    for (int i = 0; i < embeddedModelsCount(); i++) {
+        const auto file = files.find(embeddedModelName(i));
+        if (file == files.end()) {
+            std::cout << "Embedded model " << i << " " << embeddedModelName(i) << ": no json file" << std::endl;
+            failures++;
+            continue;
+        }
+
+        std::cout << "Testing embedded model " << i << ": " << file->second.string() << std::endl;
+
+        try {
+            std::ifstream jsonStream(file->second, std::ifstream::binary);
+            nlohmann::json modelData;
+            jsonStream >> modelData;
+
+            std::string where;
+            const bool success = sameJson(modelData, embeddedModelJson(i), where);
+            std::cout << "  " << (success ? "OK" : "FAIL at " + where) << std::endl;
+            failures += !success;
+
+            if (const EmbeddedEngine* engine = embeddedModelEngine(i); engine != nullptr) {
+                const bool same_engine = sameEngine(modelData, *engine, where);
+                std::cout << "  " << engine->alias << " " << (same_engine ? "OK" : "FAIL at " + where) << std::endl;
+                failures += !same_engine;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cout << std::endl << "Unable to load model: " << file->second.string() << std::endl;
+            std::cout << e.what() << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,444 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <iostream>
+#include <random>
+#include <RTNeural/RTNeural.h>
+
+#include "rt-neural-generic.h"
+
+#include "test_random.h"
+
+#define TEST_SAMPLES 4096
+/* Engines are run block by block, as the plugin does */
+#define TEST_BLOCK 256
+/* Engines use libm tanhf while RTNeural has its own activations, allow for float rounding */
+#define TEST_THR 1.0e-4
+
+using namespace std;
+
+static std::vector<float> testInput() {
+    std::vector<float> input(TEST_SAMPLES);
+    for (int i = 0; i < TEST_SAMPLES; i++)
+        input[i] = 0.5f * sinf(2.0f * M_PI * 110.0f * i / 48000.0f);
+    return input;
+}
+
+/* Output of the engine built by backend for the model file, fed with input */
+static std::vector<float> runEngine(const ModelBackend& backend, const nlohmann::json& model_json, const std::vector<float>& input) {
+    ModelArena arena;
+    EnginePtr<ModelEngine> engine(backend.create(model_json, arena));
+    std::unique_ptr<DynamicModel> model = std::make_unique<DynamicModel>();
+    model->input_skip = false;
+    std::vector<float> out = input;
+    for (size_t start = 0; start < out.size(); start += TEST_BLOCK)
+        engine->process(model.get(), out.data() + start, std::min(out.size() - start, static_cast<size_t>(TEST_BLOCK)));
+    return out;
+}
+
+static bool report(const char* name, const std::vector<float>& output, const std::vector<float>& reference) {
+    float max_error = 0.0f;
+    for (size_t i = 0; i < output.size(); i++)
+        max_error = std::max(std::abs(output[i] - reference[i]), max_error);
+    const bool success = max_error <= TEST_THR;
+    printf("  %s: max err %.12f, thr: %.12f %s\n", name, max_error, TEST_THR, success ? "OK" : "FAIL");
+    return success;
+}
+
+/* Malformed model files must be refused when the engine is built */
+static bool rejects(const char* name, const ModelBackend& backend, const nlohmann::json& model_json) {
+    bool success = false;
+    try {
+        ModelArena arena;
+        EnginePtr<ModelEngine> engine(backend.create(model_json, arena));
+    }
+    catch (const std::invalid_argument&) {
+        success = true;
+    }
+    printf("  %s: %s\n", name, success ? "rejected OK" : "accepted FAIL");
+    return success;
+}
+
+/* What RTNeural dynamic model makes of the same model file */
+static std::vector<float> rtneuralReference(const nlohmann::json& model_json, const std::vector<float>& input) {
+    std::unique_ptr<RTNeural::Model<float>> model = RTNeural::json_parser::parseJson<float>(model_json, false);
+    model->reset();
+    std::vector<float> output(input.size());
+    for (size_t i = 0; i < input.size(); i++)
+        output[i] = model->forward(&input[i]);
+    return output;
+}
+
+/**********************************************************************************************************************************************************/
+
+/* Conv1d layer with random weights, kernel laid out as kernel_size x in_size x channels */
+static nlohmann::json convLayer(int in_size, int out_size, int kernel_size, int dilation, const std::string& activation, bool residual) {
+    const int conv_size = activation == "gated" ? 2 * out_size : out_size;
+    std::vector<std::vector<std::vector<float>>> kernel;
+    for (int j = 0; j < kernel_size; j++)
+        kernel.push_back(randomMatrix(in_size, conv_size));
+    return {
+        { "type", "conv1d" },
+        { "activation", activation },
+        { "shape", { nullptr, nullptr, out_size } },
+        { "kernel_size", { kernel_size } },
+        { "dilation", { dilation } },
+        { "residual", residual },
+        { "weights", { kernel, randomMatrix(1, conv_size)[0] } }
+    };
+}
+
+static nlohmann::json denseLayer(int in_size, int out_size) {
+    return {
+        { "type", "dense" },
+        { "activation", "" },
+        { "shape", { nullptr, nullptr, out_size } },
+        { "weights", { randomMatrix(in_size, out_size), randomMatrix(1, out_size)[0] } }
+    };
+}
+
+/* Straight from the definition in conv-engine.cpp, on the whole input at once */
+static std::vector<float> convReference(const nlohmann::json& model_json, const std::vector<float>& input) {
+    const float input_gain = model_json.contains("in_gain") ? DB_CO(model_json.at("in_gain").get<float>()) : 1.0f;
+    const float output_gain = model_json.contains("out_gain") ? DB_CO(model_json.at("out_gain").get<float>()) : 1.0f;
+
+    std::vector<std::vector<float>> x(input.size(), std::vector<float>(1));
+    for (size_t t = 0; t < input.size(); t++)
+        x[t][0] = input[t] * input_gain;
+
+    for (const nlohmann::json& json_layer : model_json.at("layers")) {
+        const std::string type = json_layer.at("type");
+        const std::string activation = json_layer.at("activation");
+        const int out_size = json_layer.at("shape").back();
+        const int kernel_size = type == "conv1d" ? json_layer.at("kernel_size").back().get<int>() : 1;
+        const int dilation = type == "conv1d" ? json_layer.at("dilation").back().get<int>() : 1;
+        const std::vector<std::vector<std::vector<float>>> kernel = type == "conv1d"
+            ? json_layer.at("weights").at(0).get<std::vector<std::vector<std::vector<float>>>>()
+            : std::vector<std::vector<std::vector<float>>> { json_layer.at("weights").at(0) };
+        const std::vector<float> bias = json_layer.at("weights").at(1);
+
+        std::vector<std::vector<float>> y(x.size(), std::vector<float>(out_size));
+        for (size_t t = 0; t < x.size(); t++) {
+            std::vector<float> acc = bias;
+            for (int j = 0; j < kernel_size; j++) {
+                const int tap = static_cast<int>(t) - (kernel_size - 1 - j) * dilation;
+                if (tap < 0)
+                    continue;
+                for (size_t c = 0; c < x[tap].size(); c++)
+                    for (size_t o = 0; o < acc.size(); o++)
+                        acc[o] += kernel[j][c][o] * x[tap][c];
+            }
+            for (int o = 0; o < out_size; o++) {
+                if (activation == "tanh")
+                    y[t][o] = tanh(acc[o]);
+                else if (activation == "gated")
+                    y[t][o] = tanh(acc[o]) / (1.0 + exp(-acc[out_size + o]));
+                else
+                    y[t][o] = acc[o];
+                if (json_layer.value("residual", false))
+                    y[t][o] += x[t][o];
+            }
+        }
+        x = std::move(y);
+    }
+
+    std::vector<float> output(x.size());
+    for (size_t t = 0; t < x.size(); t++)
+        output[t] = x[t][0] * output_gain;
+    return output;
+}
+
+/**
+ * Dilated stacks with history longer than a block, gated and residual layers, with gains folded
+ * into a linear last layer or applied after a tanh one.
+ */
+static int testConv() {
+    int failures = 0;
+    const std::vector<float> input = testInput();
+
+    nlohmann::json model_json;
+    model_json["in_shape"] = { nullptr, nullptr, 1 };
+    model_json["in_gain"] = -6.0f;
+    model_json["out_gain"] = 3.0f;
+    model_json["layers"] = {
+        convLayer(1, 8, 3, 1, "tanh", false),
+        convLayer(8, 8, 3, 32, "gated", true),
+        convLayer(8, 8, 2, 128, "", true),
+        denseLayer(8, 1)
+    };
+    failures += !report("conv, gains folded", runEngine(model_backend_conv, model_json, input), convReference(model_json, input));
+
+    model_json.erase("in_gain");
+    model_json.erase("out_gain");
+    model_json["layers"] = {
+        convLayer(1, 4, 5, 4, "gated", false),
+        convLayer(4, 1, 2, 300, "tanh", false)
+    };
+    failures += !report("conv, no gains", runEngine(model_backend_conv, model_json, input), convReference(model_json, input));
+
+    /* A zero kernel matches its empty weights, history would go negative */
+    for (const auto& [kernel_size, dilation] : { std::make_pair(0, 1), std::make_pair(2, 0), std::make_pair(2, -3) }) {
+        model_json["layers"] = { convLayer(1, 1, kernel_size, dilation, "", false) };
+        failures += !rejects(("conv, kernel " + std::to_string(kernel_size) + " dilation " + std::to_string(dilation)).c_str(), model_backend_conv, model_json);
+    }
+
+    return failures;
+}
+
+/**********************************************************************************************************************************************************/
+
+/* Recurrent layer with random weights, laid out as in the json model files */
+static nlohmann::json recurrentLayer(const std::string& type, int in_size, int hidden_size) {
+    const int gates_size = (type == "lstm" ? 4 : 3) * hidden_size;
+    nlohmann::json weights = { randomMatrix(in_size, gates_size), randomMatrix(hidden_size, gates_size) };
+    if (type == "lstm")
+        weights.push_back(randomMatrix(1, gates_size)[0]);
+    else
+        weights.push_back(randomMatrix(2, gates_size));
+    return {
+        { "type", type },
+        { "activation", "" },
+        { "shape", { nullptr, nullptr, hidden_size } },
+        { "weights", weights }
+    };
+}
+
+static nlohmann::json recurrentModel(const std::vector<nlohmann::json>& recurrent_layers) {
+    nlohmann::json model_json;
+    model_json["in_shape"] = { nullptr, nullptr, 1 };
+    model_json["layers"] = recurrent_layers;
+    model_json["layers"].push_back(denseLayer(recurrent_layers.back().at("shape").back(), 1));
+    return model_json;
+}
+
+/* Zero out most of the 1 x 8 blocks of the recurrent kernel, as block pruning does */
+static void pruneBlocks(nlohmann::json& json_layer) {
+    std::bernoulli_distribution pruned(0.7);
+    std::vector<std::vector<float>> kernel = json_layer.at("weights").at(1);
+    for (auto& row : kernel)
+        for (size_t col = 0; col < row.size(); col += 8)
+            if (pruned(rng))
+                std::fill(row.begin() + col, row.begin() + std::min(col + 8, row.size()), 0.0f);
+    json_layer["weights"][1] = kernel;
+}
+
+/* Random mask on the recurrent kernel, the layer as RTNeural sees it gets the masked kernel */
+static nlohmann::json addMask(nlohmann::json& json_layer) {
+    std::bernoulli_distribution kept(0.3);
+    std::vector<std::vector<float>> kernel = json_layer.at("weights").at(1);
+    std::vector<std::vector<float>> mask(kernel.size(), std::vector<float>(kernel[0].size()));
+    for (size_t i = 0; i < kernel.size(); i++) {
+        for (size_t j = 0; j < kernel[i].size(); j++) {
+            mask[i][j] = kept(rng) ? 1.0f : 0.0f;
+            kernel[i][j] *= mask[i][j];
+        }
+    }
+    json_layer["mask"] = mask;
+    nlohmann::json masked_layer = json_layer;
+    masked_layer.erase("mask");
+    masked_layer["weights"][1] = kernel;
+    return masked_layer;
+}
+
+static bool testSparse(const char* name, const nlohmann::json& model_json, const nlohmann::json& reference_json, const std::vector<float>& input) {
+    if (!isSparseModel(model_json)) {
+        printf("  %s: not taken for a sparse model FAIL\n", name);
+        return false;
+    }
+    return report(name, runEngine(model_backend_sparse, model_json, input), rtneuralReference(reference_json, input));
+}
+
+/**
+ * Block-pruned kernels, single and stacked layers and gate sizes not a multiple of the block, then
+ * unstructured masks, which must be applied to the kernel found in the model file.
+ */
+static int testSparseEngine() {
+    int failures = 0;
+    const std::vector<float> input = testInput();
+
+    for (const auto& [type, hidden_size] : { std::make_pair("lstm", 16), std::make_pair("gru", 24), std::make_pair("gru", 12) }) {
+        nlohmann::json json_layer = recurrentLayer(type, 1, hidden_size);
+        pruneBlocks(json_layer);
+        const nlohmann::json model_json = recurrentModel({ json_layer });
+        const std::string name = std::string("sparse ") + type + " " + std::to_string(hidden_size) + ", pruned";
+        failures += !testSparse(name.c_str(), model_json, model_json, input);
+    }
+
+    {
+        std::vector<nlohmann::json> json_layers = { recurrentLayer("lstm", 1, 16), recurrentLayer("lstm", 16, 16) };
+        for (nlohmann::json& json_layer : json_layers)
+            pruneBlocks(json_layer);
+        const nlohmann::json model_json = recurrentModel(json_layers);
+        failures += !testSparse("sparse lstm 2x16, pruned", model_json, model_json, input);
+    }
+
+    for (const auto& [type, hidden_size] : { std::make_pair("lstm", 16), std::make_pair("gru", 12) }) {
+        nlohmann::json model_json = recurrentModel({ recurrentLayer(type, 1, hidden_size) });
+        nlohmann::json reference_json = model_json;
+        reference_json["layers"][0] = addMask(model_json["layers"][0]);
+        const std::string name = std::string("sparse ") + type + " " + std::to_string(hidden_size) + ", mask";
+        failures += !testSparse(name.c_str(), model_json, reference_json, input);
+    }
+
+    return failures;
+}
+
+/**********************************************************************************************************************************************************/
+
+static std::vector<std::vector<float>> identityMatrix(int size) {
+    std::vector<std::vector<float>> matrix(size, std::vector<float>(size, 0.0f));
+    for (int i = 0; i < size; i++)
+        matrix[i][i] = 1.0f;
+    return matrix;
+}
+
+static std::vector<std::vector<float>> multiply(const std::vector<std::vector<float>>& a, const std::vector<std::vector<float>>& b) {
+    std::vector<std::vector<float>> product(a.size(), std::vector<float>(b[0].size(), 0.0f));
+    for (size_t i = 0; i < a.size(); i++)
+        for (size_t k = 0; k < b.size(); k++)
+            for (size_t j = 0; j < b[0].size(); j++)
+                product[i][j] += a[i][k] * b[k][j];
+    return product;
+}
+
+/* The engine info, which tells the rank picked, must start with info_prefix */
+static bool testLowRank(const char* name, const nlohmann::json& model_json, const std::vector<float>& input, const std::string& info_prefix) {
+    if (!isLowRankModel(model_json)) {
+        printf("  %s: not taken for a low-rank model FAIL\n", name);
+        return false;
+    }
+    ModelArena arena;
+    EnginePtr<ModelEngine> engine(model_backend_lowrank.create(model_json, arena));
+    const std::string info = engine->getInfo();
+    if (info.rfind(info_prefix, 0) != 0) {
+        printf("  %s: %s, expected %s FAIL\n", name, info.c_str(), info_prefix.c_str());
+        return false;
+    }
+    printf("  %s: %s\n", name, info.c_str());
+    return report(name, runEngine(model_backend_lowrank, model_json, input), rtneuralReference(model_json, input));
+}
+
+/**
+ * Full rank factors given in the model file, then the rank selection on a kernel of rank 8, which
+ * must settle on that rank: the error on input_batch, as produced by RTNeural, stays within budget.
+ */
+static int testLowRankEngine() {
+    int failures = 0;
+    const std::vector<float> input = testInput();
+
+    for (const auto& [type, hidden_size] : { std::make_pair("lstm", 32), std::make_pair("gru", 40) }) {
+        nlohmann::json model_json = recurrentModel({ recurrentLayer(type, 1, hidden_size) });
+        nlohmann::json& json_layer = model_json["layers"][0];
+        json_layer["recurrent_factors"] = { identityMatrix(hidden_size), json_layer.at("weights").at(1) };
+        const std::string name = std::string("lowrank ") + type + " " + std::to_string(hidden_size) + ", full rank factors";
+        failures += !testLowRank(name.c_str(), model_json, input, "rank " + std::to_string(hidden_size) + " from model file");
+    }
+
+    for (const auto& [type, hidden_size] : { std::make_pair("lstm", 32), std::make_pair("gru", 48) }) {
+        nlohmann::json model_json = recurrentModel({ recurrentLayer(type, 1, hidden_size) });
+        const int gates_size = (std::string(type) == "lstm" ? 4 : 3) * hidden_size;
+        model_json["layers"][0]["weights"][1] = multiply(randomMatrix(hidden_size, 8), randomMatrix(8, gates_size));
+        model_json["input_batch"] = input;
+        model_json["output_batch"] = rtneuralReference(model_json, input);
+        const std::string name = std::string("lowrank ") + type + " " + std::to_string(hidden_size) + ", rank 8 kernel";
+        failures += !testLowRank(name.c_str(), model_json, input, "rank 8 of " + std::to_string(hidden_size));
+    }
+
+    return failures;
+}
+
+/**********************************************************************************************************************************************************/
+
+/* Runs engine block by block, from its warm state */
+static std::vector<float> runWarm(ModelEngine* engine, const std::vector<float>& input) {
+    std::unique_ptr<DynamicModel> model = std::make_unique<DynamicModel>();
+    model->input_skip = false;
+    engine->restoreState();
+    std::vector<float> out = input;
+    for (size_t start = 0; start < out.size(); start += TEST_BLOCK)
+        engine->process(model.get(), out.data() + start, std::min(out.size() - start, static_cast<size_t>(TEST_BLOCK)));
+    return out;
+}
+
+/**
+ * An engine restored from its image, as the model cache does, runs bit exact with the one it has
+ * been serialized from, from the same warm state. A truncated image is refused.
+ */
+static bool testRoundTrip(const char* name, const ModelBackend& backend, const nlohmann::json& model_json, const std::vector<float>& input) {
+    ModelArena arena;
+    EnginePtr<ModelEngine> engine(backend.create(model_json, arena));
+    runWarm(engine.get(), input);
+    engine->saveState();
+    ModelImage image;
+    engine->serialize(image, model_json);
+
+    ModelArena restored_arena;
+    ModelImageReader reader(image.bytes.data(), image.bytes.size());
+    EnginePtr<ModelEngine> restored(backend.restore(reader, restored_arena));
+    const std::vector<float> output = runWarm(restored.get(), input);
+    const std::vector<float> reference = runWarm(engine.get(), input);
+    bool success = output == reference;
+    printf("  %s: %zu bytes image, restored %s\n", name, image.bytes.size(), success ? "bit exact OK" : "differs FAIL");
+
+    bool refused = false;
+    try {
+        ModelArena truncated_arena;
+        ModelImageReader truncated(image.bytes.data(), image.bytes.size() / 2);
+        EnginePtr<ModelEngine> truncated_engine(backend.restore(truncated, truncated_arena));
+    }
+    catch (const std::runtime_error&) {
+        refused = true;
+    }
+    printf("  %s: truncated image %s\n", name, refused ? "refused OK" : "accepted FAIL");
+    return success && refused;
+}
+
+static int testRoundTrips() {
+    int failures = 0;
+    const std::vector<float> input = testInput();
+
+    nlohmann::json conv_json;
+    conv_json["in_shape"] = { nullptr, nullptr, 1 };
+    conv_json["in_gain"] = -6.0f;
+    conv_json["out_gain"] = 3.0f;
+    conv_json["layers"] = { convLayer(1, 8, 3, 1, "tanh", false), convLayer(8, 8, 2, 64, "gated", true), denseLayer(8, 1) };
+    failures += !testRoundTrip("conv", model_backend_conv, conv_json, input);
+
+    nlohmann::json sparse_json = recurrentModel({ recurrentLayer("lstm", 1, 16) });
+    pruneBlocks(sparse_json["layers"][0]);
+    failures += !testRoundTrip("sparse lstm 16", model_backend_sparse, sparse_json, input);
+
+    nlohmann::json lowrank_json = recurrentModel({ recurrentLayer("gru", 1, 48) });
+    lowrank_json["layers"][0]["weights"][1] = multiply(randomMatrix(48, 8), randomMatrix(8, 3 * 48));
+    lowrank_json["input_batch"] = input;
+    lowrank_json["output_batch"] = rtneuralReference(lowrank_json, input);
+    failures += !testRoundTrip("lowrank gru 48", model_backend_lowrank, lowrank_json, input);
+
+    for (const auto& [type, hidden_size] : { std::make_pair("lstm", 16), std::make_pair("gru", 12) }) {
+        const std::string name = std::string("stl ") + type + " " + std::to_string(hidden_size);
+        failures += !testRoundTrip(name.c_str(), model_backend_stl, recurrentModel({ recurrentLayer(type, 1, hidden_size) }), input);
+    }
+
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+
+    std::cout << "Testing conv engine" << std::endl;
+    failures += testConv();
+
+    std::cout << "Testing sparse engine" << std::endl;
+    failures += testSparseEngine();
+
+    std::cout << "Testing lowrank engine" << std::endl;
+    failures += testLowRankEngine();
+
+    std::cout << "Testing engine images" << std::endl;
+    failures += testRoundTrips();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+/* Fixed seed, so that failures can be reproduced */
+static std::mt19937 rng(0x5eed);
+
+static std::vector<std::vector<float>> randomMatrix(int rows, int cols) {
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::vector<std::vector<float>> matrix(rows, std::vector<float>(cols));
+    for (auto& row : matrix)
+        for (float& w : row)
+            w = dist(rng);
+    return matrix;
+}
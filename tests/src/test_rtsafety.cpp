@@ -0,0 +1,487 @@
+/**
+ * Realtime safety of the plugin: drives instantiate -> run -> model load and swap -> run through a
+ * stub host, with memory allocation, locking, sleeping, i/o and logging calls interposed. Any of
+ * them reached from run() or work_response() is reported with its call stack and fails the test.
+ * Worker jobs run in between, outside of the realtime sections, like a host worker thread would.
+ * Model loader builds also go through a PIPELINE pass, paced at the period like a host would run
+ * it. Non-loader builds (rtsafety_channels) load embedded models from the model index control and
+ * switch channels.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rt-neural-generic.h"
+
+#ifndef AIDADSP_MODELS_DIR
+#define AIDADSP_MODELS_DIR "../models"
+#endif
+
+#define SAMPLE_RATE 48000.0
+#define BLOCK_SIZE 256
+#define LOAD_TIMEOUT_MS 30000
+#define MAX_WORKER_MESSAGES 64
+#define MAX_WORKER_MESSAGE_SIZE 2048
+#define ATOM_BUFFER_SIZE 8192
+#define PIPELINE_BLOCKS 400
+
+/**********************************************************************************************************************************************************/
+
+/* Set by the test around run() and work_response(), per thread: loader threads may do as they like */
+static thread_local bool rt_section = false;
+static std::atomic<int> rt_violations { 0 };
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+/* Report with no allocation, realtime checks are off meanwhile */
+static void rtViolation(const char* call)
+{
+    rt_section = false;
+    rt_violations++;
+
+    char line[128];
+    const int n = snprintf(line, sizeof(line), "Realtime violation: %s\n", call);
+    syscall(SYS_write, STDERR_FILENO, line, n);
+    void* frames[32];
+    backtrace_symbols_fd(frames, backtrace(frames, 32), STDERR_FILENO);
+
+    rt_section = true;
+}
+
+#define CHECK_RT(call) do { if (rt_section) rtViolation(call); } while (0)
+
+extern "C" {
+
+void* malloc(size_t size) { CHECK_RT("malloc"); return __libc_malloc(size); }
+void* calloc(size_t n, size_t size) { CHECK_RT("calloc"); return __libc_calloc(n, size); }
+void* realloc(void* ptr, size_t size) { CHECK_RT("realloc"); return __libc_realloc(ptr, size); }
+void* memalign(size_t alignment, size_t size) { CHECK_RT("memalign"); return __libc_memalign(alignment, size); }
+void* aligned_alloc(size_t alignment, size_t size) { CHECK_RT("aligned_alloc"); return __libc_memalign(alignment, size); }
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    CHECK_RT("posix_memalign");
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr != nullptr ? 0 : ENOMEM;
+}
+void free(void* ptr) { if (ptr != nullptr) CHECK_RT("free"); __libc_free(ptr); }
+
+}
+
+/* Everything else goes on to libc, looked up before any realtime section or on first call */
+#define INTERPOSE(ret, name, params, args) \
+    static ret (*real_##name) params = nullptr; \
+    extern "C" ret name params \
+    { \
+        CHECK_RT(#name); \
+        if (real_##name == nullptr) \
+            real_##name = (ret (*) params) dlsym(RTLD_NEXT, #name); \
+        return real_##name args; \
+    }
+
+INTERPOSE(void*, mmap, (void* addr, size_t length, int prot, int flags, int fd, off_t offset), (addr, length, prot, flags, fd, offset))
+INTERPOSE(int, munmap, (void* addr, size_t length), (addr, length))
+INTERPOSE(int, mlock, (const void* addr, size_t len), (addr, len))
+INTERPOSE(ssize_t, write, (int fd, const void* buf, size_t count), (fd, buf, count))
+INTERPOSE(ssize_t, read, (int fd, void* buf, size_t count), (fd, buf, count))
+INTERPOSE(int, pthread_mutex_lock, (pthread_mutex_t* mutex), (mutex))
+INTERPOSE(int, pthread_cond_wait, (pthread_cond_t* cond, pthread_mutex_t* mutex), (cond, mutex))
+INTERPOSE(int, sem_wait, (sem_t* sem), (sem))
+INTERPOSE(int, sem_post, (sem_t* sem), (sem))
+INTERPOSE(int, nanosleep, (const struct timespec* req, struct timespec* rem), (req, rem))
+INTERPOSE(int, usleep, (useconds_t usec), (usec))
+
+/* futex is only reachable through syscall(), forwarded with as many arguments as futex takes */
+static long (*real_syscall)(long number, ...) = nullptr;
+extern "C" long syscall(long number, ...)
+{
+    va_list args;
+    va_start(args, number);
+    long a[6];
+    for (int i = 0; i < 6; i++)
+        a[i] = va_arg(args, long);
+    va_end(args);
+    if (number == SYS_futex)
+        CHECK_RT("futex");
+    if (real_syscall == nullptr)
+        real_syscall = (long (*)(long, ...)) dlsym(RTLD_NEXT, "syscall");
+    return real_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+template <typename T>
+static void lookup(T& function, const char* name)
+{
+    function = (T) dlsym(RTLD_NEXT, name);
+    if (function == nullptr) {
+        std::cout << "Unable to find " << name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void lookupRealFunctions()
+{
+    lookup(real_mmap, "mmap");
+    lookup(real_munmap, "munmap");
+    lookup(real_mlock, "mlock");
+    lookup(real_write, "write");
+    lookup(real_read, "read");
+    lookup(real_pthread_mutex_lock, "pthread_mutex_lock");
+    lookup(real_pthread_cond_wait, "pthread_cond_wait");
+    lookup(real_sem_wait, "sem_wait");
+    lookup(real_sem_post, "sem_post");
+    lookup(real_nanosleep, "nanosleep");
+    lookup(real_usleep, "usleep");
+    lookup(real_syscall, "syscall");
+
+    // first backtrace loads libgcc, not to happen in a realtime section
+    void* frames[4];
+    backtrace(frames, 4);
+}
+
+/**********************************************************************************************************************************************************/
+
+/* Stub host: URID map, log and worker queues, all fixed size but the map */
+static std::vector<std::string> mapped_uris;
+
+static LV2_URID mapUri(LV2_URID_Map_Handle, const char* uri)
+{
+    auto it = std::find(mapped_uris.begin(), mapped_uris.end(), uri);
+    if (it == mapped_uris.end())
+        it = mapped_uris.insert(it, uri);
+    return static_cast<LV2_URID>(it - mapped_uris.begin() + 1);
+}
+
+static int logVprintf(LV2_Log_Handle, LV2_URID, const char* fmt, va_list ap)
+{
+    CHECK_RT("lv2_log");
+    return vprintf(fmt, ap);
+}
+
+static int logPrintf(LV2_Log_Handle handle, LV2_URID type, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const int ret = logVprintf(handle, type, fmt, args);
+    va_end(args);
+    return ret;
+}
+
+struct MessageQueue {
+    uint8_t data[MAX_WORKER_MESSAGES][MAX_WORKER_MESSAGE_SIZE];
+    uint32_t sizes[MAX_WORKER_MESSAGES];
+    int count;
+
+    LV2_Worker_Status push(uint32_t size, const void* message)
+    {
+        if (count == MAX_WORKER_MESSAGES || size > MAX_WORKER_MESSAGE_SIZE)
+            return LV2_WORKER_ERR_NO_SPACE;
+        memcpy(data[count], message, size);
+        sizes[count++] = size;
+        return LV2_WORKER_SUCCESS;
+    }
+};
+
+static MessageQueue scheduled;
+static MessageQueue responses;
+
+static LV2_Worker_Status scheduleWork(LV2_Worker_Schedule_Handle, uint32_t size, const void* data)
+{
+    return scheduled.push(size, data);
+}
+
+static LV2_Worker_Status respond(LV2_Worker_Respond_Handle, uint32_t size, const void* data)
+{
+    return responses.push(size, data);
+}
+
+/**********************************************************************************************************************************************************/
+
+struct TestHost {
+    const LV2_Descriptor* descriptor;
+    const LV2_Worker_Interface* worker;
+    LV2_Handle instance;
+    float controls[PLUGIN_PORT_COUNT];
+    float in[BLOCK_SIZE];
+    float out[BLOCK_SIZE];
+    alignas(8) uint8_t control_buffer[ATOM_BUFFER_SIZE];
+    alignas(8) uint8_t notify_buffer[ATOM_BUFFER_SIZE];
+    LV2_Atom_Forge forge;
+    PluginURIs uris;
+    uint64_t frames;
+    int applied; /* Models swapped in by work_response */
+};
+
+#if AIDADSP_MODEL_LOADER
+static void clearControlSequence(TestHost& host)
+{
+    lv2_atom_forge_set_buffer(&host.forge, host.control_buffer, sizeof(host.control_buffer));
+    LV2_Atom_Forge_Frame frame;
+    lv2_atom_forge_sequence_head(&host.forge, &frame, 0);
+    lv2_atom_forge_pop(&host.forge, &frame);
+}
+
+/* Same message a host or ui sends to load a json model file */
+static void writeSetFile(TestHost& host, const std::string& path)
+{
+    lv2_atom_forge_set_buffer(&host.forge, host.control_buffer, sizeof(host.control_buffer));
+    LV2_Atom_Forge_Frame sequence_frame;
+    lv2_atom_forge_sequence_head(&host.forge, &sequence_frame, 0);
+    lv2_atom_forge_frame_time(&host.forge, 0);
+    write_set_file(&host.forge, &host.uris, path.c_str(), path.size());
+    lv2_atom_forge_pop(&host.forge, &sequence_frame);
+}
+#else
+/* Stands for the commercial builds mapping, each channels combination picks the next model */
+float RtNeuralGeneric::controlsToModelIndex(int modelIndex, const std::vector<float>& ctrls)
+{
+    int combination = 0;
+    for (int i = 0; i < AIDADSP_CHANNELS; i++)
+        combination |= (ctrls[i] > 0.5f) << i;
+    return static_cast<float>((modelIndex + combination) % embeddedModelsCount());
+}
+#endif
+
+static void runPlugin(TestHost& host, uint32_t n_samples)
+{
+    for (uint32_t i = 0; i < n_samples; i++)
+        host.in[i] = 0.5f * sinf(2.0f * M_PI * 110.0f * (host.frames + i) / SAMPLE_RATE);
+    host.frames += n_samples;
+
+#if AIDADSP_MODEL_LOADER
+    LV2_Atom_Sequence* notify = (LV2_Atom_Sequence*) host.notify_buffer;
+    notify->atom.size = sizeof(host.notify_buffer) - sizeof(LV2_Atom);
+#endif
+
+    rt_section = true;
+    host.descriptor->run(host.instance, n_samples);
+    rt_section = false;
+
+#if AIDADSP_MODEL_LOADER
+    clearControlSequence(host);
+#endif
+}
+
+/* Worker jobs, then their responses in the audio thread, as a host does after run */
+static void runWorker(TestHost& host)
+{
+    for (int i = 0; i < scheduled.count; i++)
+        host.worker->work(host.instance, respond, nullptr, scheduled.sizes[i], scheduled.data[i]);
+    scheduled.count = 0;
+
+    for (int i = 0; i < responses.count; i++) {
+        if (((const WorkerMessage*) responses.data[i])->type == kWorkerApply)
+            host.applied++;
+        rt_section = true;
+        host.worker->work_response(host.instance, responses.sizes[i], responses.data[i]);
+        rt_section = false;
+    }
+    responses.count = 0;
+}
+
+#if AIDADSP_MODEL_LOADER
+static bool loadModel(TestHost& host, const std::string& path)
+{
+    std::cout << "Loading " << path << std::endl;
+    const int applied = host.applied;
+    writeSetFile(host, path);
+#else
+static bool loadModel(TestHost& host, int model_index)
+{
+    std::cout << "Loading models of index " << model_index << std::endl;
+    const int applied = host.applied;
+    host.controls[PLUGIN_MODEL_INDEX] = static_cast<float>(model_index);
+#endif
+
+    for (int ms = 0; ms < LOAD_TIMEOUT_MS; ms++) {
+        runPlugin(host, BLOCK_SIZE);
+        runWorker(host);
+        if (host.applied > applied)
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::cout << "Model not loaded after " << LOAD_TIMEOUT_MS << " ms" << std::endl;
+    return false;
+}
+
+static void connectPorts(TestHost& host)
+{
+    std::fill(host.controls, host.controls + PLUGIN_PORT_COUNT, 0.0f);
+    host.controls[IN_LPF] = 66.216f;
+    host.controls[EQ_BYPASS] = 0.0f;
+    host.controls[BFREQ] = 250.0f;
+    host.controls[MFREQ] = 600.0f;
+    host.controls[MIDQ] = 0.707f;
+    host.controls[TFREQ] = 1500.0f;
+    host.controls[PLUGIN_ENABLED] = 1.0f;
+#if AIDADSP_SILENCE_CONTROLS
+    host.controls[SILENCE_THR] = -70.0f;
+    host.controls[SILENCE_HOLD] = 200.0f;
+#endif
+
+    for (uint32_t port = 0; port < PLUGIN_PORT_COUNT; port++)
+        host.descriptor->connect_port(host.instance, port, &host.controls[port]);
+    host.descriptor->connect_port(host.instance, IN, host.in);
+    host.descriptor->connect_port(host.instance, OUT_1, host.out);
+#if AIDADSP_MODEL_LOADER
+    host.descriptor->connect_port(host.instance, PLUGIN_CONTROL, host.control_buffer);
+    host.descriptor->connect_port(host.instance, PLUGIN_NOTIFY, host.notify_buffer);
+#endif
+}
+
+#if AIDADSP_PIPELINE
+/**
+ * Runs with the PIPELINE control on, paced at the period so the helper can keep up, and swaps a
+ * model in meanwhile. Returns the number of blocks the model stage ran pipelined: none on a single
+ * core, where the plugin keeps processing inline.
+ */
+static int runPipelined(TestHost& host, const std::string& path, bool& loaded)
+{
+    const auto period = std::chrono::microseconds(static_cast<int>(1e6 * BLOCK_SIZE / SAMPLE_RATE));
+    int pipelined = 0;
+
+    host.controls[PIPELINE] = 1.0f;
+    for (int i = 0; i < PIPELINE_BLOCKS; i++) {
+        auto next = std::chrono::steady_clock::now() + period;
+        if (i == PIPELINE_BLOCKS / 2) {
+            loaded = loaded && loadModel(host, path);
+            next = std::chrono::steady_clock::now() + period;
+        }
+        runPlugin(host, BLOCK_SIZE);
+        runWorker(host);
+        pipelined += host.controls[LATENCY] > 0.0f;
+        std::this_thread::sleep_until(next);
+    }
+    host.controls[PIPELINE] = 0.0f;
+    for (int i = 0; i < 10; i++) {
+        runPlugin(host, BLOCK_SIZE);
+        runWorker(host);
+    }
+    return pipelined;
+}
+#endif
+
+#if AIDADSP_MODEL_LOADER
+/* Two recurrent models to load one after the other */
+static std::vector<std::string> findModels()
+{
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(AIDADSP_MODELS_DIR)) {
+        if (entry.path().extension() == ".json")
+            paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    paths.resize(std::min(paths.size(), static_cast<size_t>(2)));
+    return paths;
+}
+#endif
+
+int main(void)
+{
+    lookupRealFunctions();
+
+    // model cache images out of the user cache directory
+    char cache_dir[] = "/tmp/aidadsp-rtsafety-XXXXXX";
+    if (mkdtemp(cache_dir) == nullptr) {
+        std::cout << "Unable to create cache directory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    setenv("XDG_CACHE_HOME", cache_dir, 1);
+
+#if AIDADSP_MODEL_LOADER
+    const std::vector<std::string> models = findModels();
+    if (models.size() < 2) {
+        std::cout << "Two json models needed in " << AIDADSP_MODELS_DIR << std::endl;
+        return EXIT_FAILURE;
+    }
+#else
+    if (embeddedModelsCount() < 2) {
+        std::cout << "Two embedded models needed" << std::endl;
+        return EXIT_FAILURE;
+    }
+#endif
+
+    static TestHost host = {};
+    LV2_URID_Map map = { nullptr, mapUri };
+    LV2_Log_Log log = { nullptr, logPrintf, logVprintf };
+    LV2_Worker_Schedule schedule = { nullptr, scheduleWork };
+    const LV2_Feature map_feature = { LV2_URID__map, &map };
+    const LV2_Feature log_feature = { LV2_LOG__log, &log };
+    const LV2_Feature schedule_feature = { LV2_WORKER__schedule, &schedule };
+    const LV2_Feature* features[] = { &map_feature, &log_feature, &schedule_feature, nullptr };
+
+    host.descriptor = lv2_descriptor(0);
+    host.worker = (const LV2_Worker_Interface*) host.descriptor->extension_data(LV2_WORKER__interface);
+    host.instance = host.descriptor->instantiate(host.descriptor, SAMPLE_RATE, ".", features);
+    if (host.instance == nullptr || host.worker == nullptr) {
+        std::cout << "Unable to instantiate the plugin" << std::endl;
+        return EXIT_FAILURE;
+    }
+    connectPorts(host);
+#if AIDADSP_MODEL_LOADER
+    lv2_atom_forge_init(&host.forge, &map);
+    map_plugin_uris(&map, &host.uris);
+    clearControlSequence(host);
+#endif
+    host.descriptor->activate(host.instance);
+
+    // pre-run, then the first model, then a swap for a second one
+    runPlugin(host, 0);
+#if AIDADSP_MODEL_LOADER
+    bool loaded = loadModel(host, models[0]);
+#else
+    bool loaded = loadModel(host, 0);
+#endif
+    for (int i = 0; i < 100; i++)
+        runPlugin(host, BLOCK_SIZE);
+#ifdef AIDADSP_CHANNELS
+    // channel switches pick another of the models loaded, with a crossfade
+    for (int channel = 1; channel < CHANNEL_COMBINATIONS; channel++) {
+        for (int i = 0; i < AIDADSP_CHANNELS; i++)
+            host.controls[CHANNEL1 + i] = (channel >> i) & 1 ? 1.0f : 0.0f;
+        for (int i = 0; i < 20; i++)
+            runPlugin(host, BLOCK_SIZE);
+    }
+#endif
+#if AIDADSP_MODEL_LOADER
+    loaded = loaded && loadModel(host, models[1]);
+#else
+    loaded = loaded && loadModel(host, 1);
+#endif
+    for (int i = 0; i < 100; i++) {
+        runPlugin(host, BLOCK_SIZE);
+        runWorker(host);
+    }
+#if AIDADSP_PIPELINE
+    const int pipelined = runPipelined(host, models[0], loaded);
+    std::cout << pipelined << " of " << PIPELINE_BLOCKS << " blocks pipelined" << std::endl;
+#endif
+
+    host.descriptor->deactivate(host.instance);
+    host.descriptor->cleanup(host.instance);
+    std::filesystem::remove_all(cache_dir);
+
+    std::cout << rt_violations << " realtime violations" << std::endl;
+    return loaded && rt_violations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
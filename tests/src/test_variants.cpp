@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <RTNeural/RTNeural.h>
+
+#include <model_variant.hpp>
+
+#include "test_random.h"
+
+#define TEST_SAMPLES 4096
+
+using namespace std;
+
+/* Random weights laid out as in the json model files */
+static nlohmann::json randomWeights(const std::string& type, int in_size, int out_size) {
+    if (type == "lstm")
+        return { randomMatrix(in_size, 4 * out_size), randomMatrix(out_size, 4 * out_size), randomMatrix(1, 4 * out_size)[0] };
+    if (type == "gru")
+        return { randomMatrix(in_size, 3 * out_size), randomMatrix(out_size, 3 * out_size), randomMatrix(2, 3 * out_size) };
+    return { randomMatrix(in_size, out_size), randomMatrix(1, out_size)[0] };
+}
+
+/* Activation layers are described by the "activation" field of the dense layer before them */
+template <typename LayerType>
+static void addLayer(nlohmann::json& json_layers, const LayerType& layer) {
+    const std::string name = layer.getName();
+    if (name == "lstm" || name == "gru" || name == "dense") {
+        json_layers.push_back({
+            { "type", name },
+            { "activation", "" },
+            { "shape", { nullptr, nullptr, LayerType::out_size } },
+            { "weights", randomWeights(name, LayerType::in_size, LayerType::out_size) }
+        });
+    }
+    else {
+        json_layers.back()["activation"] = name;
+    }
+}
+
+/* Json model file with random weights for the architecture of ModelType */
+template <typename ModelType, size_t... I>
+static nlohmann::json modelJson(ModelType& model, std::index_sequence<I...>) {
+    nlohmann::json model_json;
+    model_json["in_shape"] = { nullptr, nullptr, ModelType::input_size };
+    model_json["layers"] = nlohmann::json::array();
+    (addLayer(model_json["layers"], model.template get<I>()), ...);
+    return model_json;
+}
+
+/**
+ * Check that create_custom_model picks alias number index for a model file of its architecture,
+ * compare its output against the RTNeural dynamic model and measure its cost.
+ */
+template <size_t index>
+static bool testVariant() {
+    using ModelType = std::variant_alternative_t<index, RTNeural::ModelVariantType>;
+    if constexpr (std::is_same_v<ModelType, RTNeural::NullModel>) {
+        return true;
+    }
+    else {
+        std::unique_ptr<ModelType> model = std::make_unique<ModelType>();
+        const nlohmann::json model_json = modelJson(*model, std::make_index_sequence<RTNeural::model_layers_count<ModelType>::value>{});
+
+        const bool picked = RTNeural::create_custom_model(model_json, [](auto tag) {
+            return std::is_same_v<typename decltype(tag)::type, ModelType>;
+        });
+        if (!picked) {
+            printf("  alias %zu: picked another alias FAIL\n", index);
+            return false;
+        }
+
+        model->parseJson(model_json, false);
+        model->reset();
+        std::unique_ptr<RTNeural::Model<float>> reference = RTNeural::json_parser::parseJson<float>(model_json, false);
+        reference->reset();
+
+        float in alignas(RTNEURAL_DEFAULT_ALIGNMENT)[ModelType::input_size] = {};
+        float max_error = 0.0f;
+        for (int i = 0; i < TEST_SAMPLES; i++) {
+            in[0] = 0.5f * sinf(2.0f * M_PI * 110.0f * i / 48000.0f);
+            for (int k = 1; k < ModelType::input_size; k++)
+                in[k] = 0.5f;
+            max_error = std::max(std::abs(model->forward(in) - reference->forward(in)), max_error);
+        }
+
+        model->reset();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TEST_SAMPLES; i++) {
+            in[0] = model->forward(in) * 0.5f;
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        /* Random weights drive activations harder than trained models, allow for float rounding */
+        const double threshold = std::max(RTNeural::ActivationMathsProvider::test_threshold, 1.0e-4);
+        const bool success = max_error <= threshold;
+        printf("  alias %zu: %d layers, max err %.12f, thr: %.12f, %.1f ns/sample %s\n", index,
+            (int)RTNeural::model_layers_count<ModelType>::value, max_error, threshold, elapsed.count() / TEST_SAMPLES, success ? "OK" : "FAIL");
+        return success;
+    }
+}
+
+template <size_t... indexes>
+static int testVariants(std::index_sequence<indexes...>) {
+    return ((testVariant<indexes>() ? 0 : 1) + ...);
+}
+
+int main(void) {
+    std::cout << "Testing " << std::variant_size_v<RTNeural::ModelVariantType> - 1 << " model aliases" << std::endl;
+
+    const int failures = testVariants(std::make_index_sequence<std::variant_size_v<RTNeural::ModelVariantType>>{});
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+
+# Compiles json model files into a header for non-loader builds, in model index order:
+#   generate_embedded_models.py -o embedded_models.hpp [--fold-params] model1.json model2.json ...
+# Numeric arrays (weights, input/output batches) become one aligned float array per model, the
+# rest of the json stays as text with each array replaced by a reference into the float array.
+# Recurrent models of a model type of generate_variant_hpp.py get their layer weights first, in
+# model type order, so the plugin builds them straight from the float array, see EmbeddedEngine.
+# --fold-params must match AIDADSP_FOLD_PARAMS: params input weights then go after layer weights.
+
+import argparse
+import json
+import math
+import os
+import struct
+
+# Arrays with fewer numbers stay in the json text, e.g. shapes
+min_embedded_size = 8
+
+def float_literal(value):
+    # Hex literals are exact, round to float first as the model gets loaded
+    rounded = struct.unpack('f', struct.pack('f', value))[0]
+    if not math.isfinite(rounded):
+        raise ValueError(f'{value} is not a valid model value')
+    return rounded.hex() + 'f'
+
+def reject_constant(name):
+    raise ValueError(f'{name} is not a valid model value')
+
+def c_string(text):
+    # Quotes, backslashes and anything outside printable ascii as octal escapes of the utf-8 bytes
+    escaped = ''
+    for byte in text.encode('utf-8'):
+        char = chr(byte)
+        if char in '"\\?' or byte < 0x20 or byte > 0x7e:
+            escaped += f'\\{byte:03o}'
+        else:
+            escaped += char
+    return '"' + escaped + '"'
+
+def array_shape(node):
+    if isinstance(node, list):
+        if not node:
+            return None
+        shapes = [array_shape(item) for item in node]
+        if any(shape is None or shape != shapes[0] for shape in shapes):
+            return None
+        return [len(node)] + shapes[0]
+    if isinstance(node, (int, float)) and not isinstance(node, bool):
+        return []
+    return None
+
+def flatten(node, weights):
+    if isinstance(node, list):
+        for item in node:
+            flatten(item, weights)
+    else:
+        weights.append(float(node))
+
+def reference(node, weights):
+    shape = array_shape(node)
+    if not shape or len(shape) > 3:
+        raise ValueError('Layer weights are not a numeric array')
+    offset = len(weights)
+    flatten(node, weights)
+    return { 'embedded_offset': offset, 'embedded_shape': shape }
+
+# Same as model_shape and add_model names in generate_variant_hpp.py
+def model_type_alias(model_json, fold_params):
+    json_layers = []
+    for json_layer in model_json['layers']:
+        activation = json_layer.get('activation', '')
+        if json_layer['type'] != 'dense' or activation == 'linear':
+            activation = ''
+        json_layers.append((json_layer['type'], json_layer['shape'][-1], activation))
+    input_size = model_json['in_shape'][-1]
+    if json_layers[0][0] not in ('lstm', 'gru'):
+        return None
+    if fold_params and input_size > 1:
+        input_size = 1
+    layer_type, hidden_size = json_layers[0][0].upper(), json_layers[0][1]
+    if json_layers == [json_layers[0], ('dense', 1, '')]:
+        return f'ModelType_{layer_type}_{hidden_size}_{input_size}'
+    if json_layers == [json_layers[0]] * 2 + [('dense', 1, '')]:
+        return f'ModelType_{layer_type}_2x{hidden_size}_{input_size}'
+    if len(json_layers) == 3 and json_layers[1][0] == 'dense' and json_layers[2] == ('dense', 1, '') and json_layers[1][2]:
+        return f'ModelType_{layer_type}_{hidden_size}_Dense{json_layers[1][1]}{json_layers[1][2].capitalize()}_{input_size}'
+    return None
+
+def number(model_json, *keys, default):
+    for key in keys:
+        node = model_json
+        for name in key.split('/'):
+            node = node.get(name) if isinstance(node, dict) else None
+        if isinstance(node, (int, float)) and not isinstance(node, bool):
+            return node
+    return default
+
+# Moves layer weights of a model with a model type to the start of weights, replaced by references
+# in model_json. Returns the EmbeddedEngine initializer of the model, None when built from json.
+def embed_engine(index, model_json, weights, fold_params):
+    try:
+        alias = model_type_alias(model_json, fold_params)
+    except (KeyError, IndexError, TypeError):
+        return None
+    in_skip = number(model_json, 'in_skip', default=0)
+    if alias is None or in_skip > 1:
+        return None
+
+    json_layers = model_json['layers']
+    n_params = model_json['in_shape'][-1] - 1 if fold_params else 0
+    param_rows = []
+    for layer_index, json_layer in enumerate(json_layers):
+        tensors = []
+        for tensor_index, tensor in enumerate(json_layer['weights']):
+            if layer_index == 0 and tensor_index == 0 and n_params > 0:
+                # Audio input row only, params rows follow the layer weights
+                tensors.append([reference(tensor[0], weights)] + tensor[1:])
+                param_rows = tensors[-1]
+            else:
+                tensors.append(reference(tensor, weights))
+        json_layer['weights'] = tensors
+    n_weights = len(weights)
+    for row in range(1, len(param_rows)):
+        param_rows[row] = reference(param_rows[row], weights)
+
+    hidden_size = json_layers[0]['shape'][-1]
+    dense_input_size = json_layers[-2]['shape'][-1]
+    samplerate = number(model_json, 'metadata/samplerate', 'samplerate', default=48000)
+    param_weights = f'embedded_model_{index}_weights + {n_weights}' if n_params > 0 else 'nullptr'
+    return (f'{{ "{alias}", embedded_model_{index}_weights, {n_weights}, "{json_layers[0]["type"]}", {hidden_size}, '
+            f'{model_json["in_shape"][-1]}, {param_weights}, {n_params}, {dense_input_size}, {"true" if in_skip else "false"}, '
+            f'{float_literal(number(model_json, "in_gain", default=0))}, {float_literal(number(model_json, "out_gain", default=0))}, '
+            f'{float_literal(samplerate)} }}')
+
+def embed(node, weights):
+    shape = array_shape(node)
+    if shape and len(shape) >= 1 and len(shape) <= 3:
+        size = 1
+        for dim in shape:
+            size *= dim
+        if size >= min_embedded_size:
+            offset = len(weights)
+            flatten(node, weights)
+            return { 'embedded_offset': offset, 'embedded_shape': shape }
+    if isinstance(node, list):
+        return [embed(item, weights) for item in node]
+    if isinstance(node, dict):
+        return { key: embed(value, weights) for key, value in node.items() }
+    return node
+
+parser = argparse.ArgumentParser()
+parser.add_argument('-o', '--output', required=True)
+parser.add_argument('--fold-params', action='store_true')
+parser.add_argument('models', nargs='+')
+args = parser.parse_args()
+
+with open(args.output, 'w') as header_file:
+    header_file.write('// Generated by variant/generate_embedded_models.py, do not edit\n')
+    header_file.write('#include <stddef.h>\n')
+    header_file.write('\n')
+    header_file.write('struct EmbeddedModel { const char* name; const char* skeleton; const float* weights; size_t n_weights; const EmbeddedEngine* engine; };\n')
+    header_file.write('\n')
+
+    engines = []
+    for index, path in enumerate(args.models):
+        print(f'Embedding model {index}: {path}')
+        with open(path) as model_file:
+            model_json = json.load(model_file, parse_constant=reject_constant)
+        weights = []
+        engine = embed_engine(index, model_json, weights, args.fold_params)
+        skeleton = json.dumps(embed(model_json, weights), separators=(',', ':'), allow_nan=False)
+        if ')json"' in skeleton:
+            raise ValueError(f'{path} can\'t be embedded in a raw string')
+
+        header_file.write(f'alignas(64) static constexpr float embedded_model_{index}_weights[] = {{\n')
+        for start in range(0, len(weights), 8):
+            header_file.write('    ' + ', '.join(float_literal(w) for w in weights[start:start + 8]) + ',\n')
+        header_file.write('};\n')
+        header_file.write(f'static constexpr char embedded_model_{index}_skeleton[] = R"json({skeleton})json";\n')
+        if engine is not None:
+            print(f'  built from its weights as {engine.split(chr(34))[1]}')
+            header_file.write(f'static constexpr EmbeddedEngine embedded_model_{index}_engine = {engine};\n')
+        engines.append(f'&embedded_model_{index}_engine' if engine is not None else 'nullptr')
+        header_file.write('\n')
+
+    header_file.write('static constexpr EmbeddedModel embedded_models[] = {\n')
+    for index, path in enumerate(args.models):
+        name = os.path.splitext(os.path.basename(path))[0]
+        header_file.write(f'    {{ {c_string(name)}, embedded_model_{index}_skeleton, embedded_model_{index}_weights, '
+                          f'sizeof(embedded_model_{index}_weights) / sizeof(float), {engines[index]} }},\n')
+    header_file.write('};\n')
+    header_file.write(f'#define EMBEDDED_MODELS_COUNT {len(args.models)}\n')
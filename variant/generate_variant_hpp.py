@@ -1,66 +1,303 @@
 #!/usr/bin/env python3
 
+# Generates the model types the plugin is built with:
+#   generate_variant_hpp.py [-o output_dir] [--models dir_or_manifest ...] [--families-file file] [--fold-params]
+# With --models only the architectures of the models found are generated, from json files under a
+# directory or listed in a manifest, one path per line relative to the manifest. --families-file
+# gets the families left with at least one model type, one per line. --fold-params must match
+# AIDADSP_FOLD_PARAMS: conditioned recurrent models are then loaded as snapshot ones, input size 1,
+# and only snapshot types are generated. The checked-in headers are generated with --fold-params.
+
+import argparse
+import json
+import os
+import sys
+
+parser = argparse.ArgumentParser()
+parser.add_argument('-o', '--output-dir', default='rt-neural-generic/src')
+parser.add_argument('--models', nargs='+', default=[])
+parser.add_argument('--families-file')
+parser.add_argument('--fold-params', action='store_true')
+args = parser.parse_args()
+
 max_input_size = 3
 layer_types = ('GRU', 'LSTM')
-input_sizes = tuple(range(1, max_input_size + 1))
+# Folded conditioned models load as snapshot ones, types with more inputs would never be used
+input_sizes = (1,) if args.fold_params else tuple(range(1, max_input_size + 1))
 hidden_sizes = (8, 12, 16, 20, 24, 32, 40, 64, 80)
 
-model_variant_using_declarations = []
-model_variant_types = []
+# Stacked recurrent layers, all of the same type and hidden size
+stacked_layers = 2
+stacked_hidden_sizes = (8, 12, 16, 20, 24, 32)
+
+# Dense head after the recurrent layer: hidden_size -> head_size -> activation -> 1
+head_hidden_sizes = (16, 24, 32, 40)
+head_sizes = (8, 16)
+head_activations = ('tanh',)
+
+# Conditioned models are folded into snapshot ones (AIDADSP_FOLD_PARAMS), so stacked and head models are snapshot only
+extra_input_sizes = (1,)
+
+# Families of model types, each one can be built as a module of its own (AIDADSP_VARIANT_MODULES),
+# must match AIDADSP_VARIANT_FAMILIES in rt-neural-generic/CMakeLists.txt
+families = ('gru_small', 'gru_large', 'lstm_small', 'lstm_large')
+small_hidden_size = 24
+
+def family_of(layer_type, hidden_size):
+    return f'{layer_type.lower()}_{"small" if hidden_size <= small_hidden_size else "large"}'
+
+def family_condition(family):
+    return f'!defined(MODEL_VARIANT_FAMILY) || MODEL_VARIANT_FAMILY == MODEL_FAMILY_{family.upper()}'
+
+def model_files(models_path):
+    if os.path.isdir(models_path):
+        for root, dirs, files in sorted(os.walk(models_path)):
+            for name in sorted(files):
+                if name.endswith('.json'):
+                    yield os.path.join(root, name)
+    else:
+        with open(models_path) as manifest_file:
+            for line in manifest_file:
+                line = line.split('#')[0].strip()
+                if line:
+                    yield os.path.join(os.path.dirname(models_path), line)
+
+# Same (input size, [(type, size, activation)]) as add_model takes, see is_layers_shape below
+def model_shape(model_json):
+    json_layers = []
+    for json_layer in model_json['layers']:
+        activation = json_layer.get('activation', '')
+        if json_layer['type'] != 'dense' or activation == 'linear':
+            activation = ''
+        json_layers.append((json_layer['type'], json_layer['shape'][-1], activation))
+    input_size = model_json['in_shape'][-1]
+    if args.fold_params and input_size > 1 and json_layers[0][0] != 'conv1d':
+        input_size = 1
+    return (input_size, json_layers)
+
+# Architectures to generate, None for all of them
+used_shapes = None
+conditioned_paths = {} # Conditioned models by shape, they must still have a model type once folded
+if args.models:
+    used_shapes = {}
+    for models_path in args.models:
+        for path in model_files(models_path):
+            try:
+                with open(path) as model_file:
+                    model_json = json.load(model_file)
+                shape = model_shape(model_json)
+            except (ValueError, KeyError, IndexError, TypeError):
+                print(f'Skipping {path}: not a recurrent model file')
+                continue
+            used_shapes.setdefault(repr(shape), path)
+            if model_json['in_shape'][-1] > 1 and shape[1][0][0] != 'conv1d':
+                conditioned_paths.setdefault(repr(shape), path)
+
+model_variant_using_declarations = { family: [] for family in families }
+model_variant_types = { family: [] for family in families }
 model_type_checkers = []
+model_type_families = []
+
+def rnn_layer(layer_type, in_size, hidden_size):
+    if layer_type == 'GRU':
+        return f'RTNeural::GRULayerT<float, {in_size}, {hidden_size}, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>'
+    elif layer_type == 'LSTM':
+        return f'RTNeural::LSTMLayerT<float, {in_size}, {hidden_size}, RTNeural::SampleRateCorrectionMode::None, RTNeural::ActivationMathsProvider>'
+
+def activation_layer(activation, size):
+    if activation == 'tanh':
+        return f'RTNeural::TanhActivationT<float, {size}, RTNeural::ActivationMathsProvider>'
+    elif activation == 'relu':
+        return f'RTNeural::ReLuActivationT<float, {size}>'
+
+# json_layers is a list of (type, size, activation) as found in the json model file
+def add_model(model_type_alias, input_size, json_layers):
+    if used_shapes is not None and used_shapes.pop(repr((input_size, json_layers)), None) is None:
+        return
+    family = family_of(json_layers[0][0], json_layers[0][1])
+    model_layers = []
+    in_size = input_size
+    for json_type, size, activation in json_layers:
+        if json_type == 'dense':
+            model_layers.append(f'RTNeural::DenseT<float, {in_size}, {size}>')
+            if activation:
+                model_layers.append(activation_layer(activation, size))
+        else:
+            model_layers.append(rnn_layer(json_type.upper(), in_size, size))
+        in_size = size
+    model_type = f'RTNeural::ModelT<float, {input_size}, 1, {", ".join(model_layers)}>'
 
-def add_model(input_size, layer_type, hidden_size, model_type):
-    model_type_alias = f'ModelType_{layer_type}_{hidden_size}_{input_size}'
-    model_variant_using_declarations.append(f'using {model_type_alias} = {model_type};\n')
-    model_variant_types.append(model_type_alias)
+    print(f'Setting up Model: {model_type_alias}')
+
+    model_variant_using_declarations[family].append(f'using {model_type_alias} = {model_type};\n')
+    model_variant_types[family].append(model_type_alias)
+    model_type_families.append((model_type_alias, family))
+    layer_shapes = ', '.join(f'{{ "{json_type}", {size}, "{activation}" }}' for json_type, size, activation in json_layers)
     model_type_checkers.append(f'''inline bool is_model_type_{model_type_alias} (const nlohmann::json& model_json) {{
     const auto json_layers = model_json.at ("layers");
-    const auto rnn_layer_type = json_layers.at (0).at ("type").get<std::string>();
-    const auto is_layer_type_correct = rnn_layer_type == "{layer_type.lower()}";
-    const auto hidden_size = json_layers.at (0).at ("shape").back().get<int>();
-    const auto is_hidden_size_correct = hidden_size == {hidden_size};
     const auto input_size = model_json.at ("in_shape").back().get<int>();
     const auto is_input_size_correct = input_size == {input_size};
-    return is_layer_type_correct && is_hidden_size_correct && is_input_size_correct;
+    return is_input_size_correct && is_layers_shape (json_layers, {{ {layer_shapes} }});
 }}\n\n''')
 
 for layer_type in layer_types:
     for hidden_size in hidden_sizes:
         for input_size in input_sizes:
-            print(f'Setting up Model: {layer_type} w/ RNN dims {input_size} / {hidden_size}, w/ I/O dims {input_size} / 1')
+            add_model(f'ModelType_{layer_type}_{hidden_size}_{input_size}', input_size,
+                      [(layer_type.lower(), hidden_size, ''), ('dense', 1, '')])
+
+for layer_type in layer_types:
+    for hidden_size in stacked_hidden_sizes:
+        for input_size in extra_input_sizes:
+            add_model(f'ModelType_{layer_type}_{stacked_layers}x{hidden_size}_{input_size}', input_size,
+                      [(layer_type.lower(), hidden_size, '')] * stacked_layers + [('dense', 1, '')])
+
+for layer_type in layer_types:
+    for hidden_size in head_hidden_sizes:
+        for head_size in head_sizes:
+            for activation in head_activations:
+                for input_size in extra_input_sizes:
+                    add_model(f'ModelType_{layer_type}_{hidden_size}_Dense{head_size}{activation.capitalize()}_{input_size}', input_size,
+                              [(layer_type.lower(), hidden_size, ''), ('dense', head_size, activation), ('dense', 1, '')])
+
+if used_shapes is not None:
+    for path in used_shapes.values():
+        print(f'Warning: {path} has no matching model type, it will not load')
+    for shape, path in conditioned_paths.items():
+        if shape in used_shapes:
+            sys.exit(f'Conditioned model {path} has no model type{" once its params are folded" if args.fold_params else ""}')
+    if not model_type_families:
+        sys.exit('No supported architecture among the models given')
+
+with open(os.path.join(args.output_dir, 'model_families.hpp'), 'w') as header_file:
+    header_file.write('#pragma once\n')
+    header_file.write('#include <initializer_list>\n')
+    header_file.write('#include <string>\n')
+    header_file.write('#include <nlohmann/json.hpp>\n')
+    header_file.write('\n')
+
+    for index, family in enumerate(families):
+        header_file.write(f'#define MODEL_FAMILY_{family.upper()} {index}\n')
+    header_file.write(f'#define MODEL_FAMILIES_COUNT {len(families)}\n')
+    family_names = ', '.join(f'"{family}"' for family in families)
+    header_file.write(f'static constexpr const char* model_family_names[] = {{ {family_names} }};\n')
+    if used_shapes is None:
+        header_file.write('#define MODEL_VARIANT_UNSUPPORTED "Unable to identify a known model architecture!"\n')
+    else:
+        header_file.write('#define MODEL_VARIANT_UNSUPPORTED "Model architecture not in the variant set of this build, see AIDADSP_VARIANT_MODELS"\n')
+    header_file.write('\n')
 
-            if layer_type == 'GRU':
-                rnn_layer_type = f'RTNeural::GRULayerT<float, {input_size}, {hidden_size}>'
-            elif layer_type == 'LSTM':
-                rnn_layer_type = f'RTNeural::LSTMLayerT<float, {input_size}, {hidden_size}>'
+    header_file.write('struct LayerShape { const char* type; int size; const char* activation; };\n')
+    header_file.write('inline bool is_layers_shape (const nlohmann::json& json_layers, std::initializer_list<LayerShape> layer_shapes) {\n')
+    header_file.write('    if (json_layers.size() != layer_shapes.size())\n')
+    header_file.write('        return false;\n')
+    header_file.write('    size_t i = 0;\n')
+    header_file.write('    for (const auto& layer_shape : layer_shapes) {\n')
+    header_file.write('        const auto& json_layer = json_layers.at (i++);\n')
+    header_file.write('        const auto layer_type = json_layer.at ("type").get<std::string>();\n')
+    header_file.write('        const auto size = json_layer.at ("shape").back().get<int>();\n')
+    header_file.write('        auto activation = json_layer.contains ("activation") ? json_layer.at ("activation").get<std::string>() : std::string();\n')
+    header_file.write('        if (layer_type != "dense" || activation == "linear")\n')
+    header_file.write('            activation.clear();\n')
+    header_file.write('        if (layer_type != layer_shape.type || size != layer_shape.size || activation != layer_shape.activation)\n')
+    header_file.write('            return false;\n')
+    header_file.write('    }\n')
+    header_file.write('    return true;\n')
+    header_file.write('}\n\n')
 
-            dense_layer_type = f'RTNeural::DenseT<float, {hidden_size}, 1>'
+    header_file.writelines(model_type_checkers)
 
-            model_type = f'RTNeural::ModelT<float, {input_size}, 1, {rnn_layer_type}, {dense_layer_type}>'
-            add_model(input_size, layer_type, hidden_size, model_type)
+    header_file.write('inline int model_family (const nlohmann::json& model_json) {\n')
+    for alias, family in model_type_families:
+        header_file.write(f'    if (is_model_type_{alias} (model_json))\n')
+        header_file.write(f'        return MODEL_FAMILY_{family.upper()};\n')
+    header_file.write('    return -1;\n')
+    header_file.write('}\n')
+    header_file.write('\n')
 
-with open("rt-neural-generic/src/model_variant.hpp", "w") as header_file:
+    # Same on a model type name, for engines serialized in a cache image
+    header_file.write('inline int model_alias_family (const std::string& alias) {\n')
+    for alias, family in model_type_families:
+        header_file.write(f'    if (alias == "{alias}")\n')
+        header_file.write(f'        return MODEL_FAMILY_{family.upper()};\n')
+    header_file.write('    return -1;\n')
+    header_file.write('}\n')
+
+with open(os.path.join(args.output_dir, 'model_variant.hpp'), 'w') as header_file:
     header_file.write('#include <variant>\n')
     header_file.write('#include <RTNeural/RTNeural.h>\n')
+    header_file.write('#include "activations.hpp"\n')
+    header_file.write('#include <model_families.hpp>\n')
     header_file.write('\n')
 
     header_file.write(f'#define MAX_INPUT_SIZE {max_input_size}\n')
 
+    # Model types and traits differ with the backend, they go in the RTNeural namespace which is renamed per backend
+    header_file.write('\n')
+    header_file.write('namespace RTNeural {\n')
+
     header_file.write('struct NullModel { static constexpr int input_size = 0; static constexpr int output_size = 0; };\n')
-    header_file.writelines(model_variant_using_declarations)
-    header_file.write(f'using ModelVariantType = std::variant<NullModel,{",".join(model_variant_types)}>;\n')
+    header_file.write('template <typename LayerType> struct is_lstm_layer : std::false_type {};\n')
+    header_file.write('template <typename T, int in_size, int out_size, RTNeural::SampleRateCorrectionMode mode, typename MathsProvider>\n')
+    header_file.write('struct is_lstm_layer<RTNeural::LSTMLayerT<T, in_size, out_size, mode, MathsProvider>> : std::true_type {};\n')
+    header_file.write('template <typename LayerType> struct is_gru_layer : std::false_type {};\n')
+    header_file.write('template <typename T, int in_size, int out_size, RTNeural::SampleRateCorrectionMode mode, typename MathsProvider>\n')
+    header_file.write('struct is_gru_layer<RTNeural::GRULayerT<T, in_size, out_size, mode, MathsProvider>> : std::true_type {};\n')
+    header_file.write('template <typename LayerType> struct is_dense_layer : std::false_type {};\n')
+    header_file.write('template <typename T, int in_size, int out_size>\n')
+    header_file.write('struct is_dense_layer<RTNeural::DenseT<T, in_size, out_size>> : std::true_type {};\n')
+    header_file.write('template <typename ModelType> struct model_layers_count : std::integral_constant<size_t, 0> {};\n')
+    header_file.write('template <typename T, int in_size, int out_size, typename... Layers>\n')
+    header_file.write('struct model_layers_count<RTNeural::ModelT<T, in_size, out_size, Layers...>> : std::integral_constant<size_t, sizeof...(Layers)> {};\n')
+    # MODEL_VARIANT_FAMILY, when defined, restricts the variant to one family
+    for family in families:
+        if not model_variant_types[family]:
+            header_file.write(f'#define MODEL_VARIANT_TYPES_{family.upper()}\n')
+            continue
+        header_file.write(f'#if {family_condition(family)}\n')
+        header_file.writelines(model_variant_using_declarations[family])
+        header_file.write(f'#define MODEL_VARIANT_TYPES_{family.upper()} ,{",".join(model_variant_types[family])}\n')
+        header_file.write('#else\n')
+        header_file.write(f'#define MODEL_VARIANT_TYPES_{family.upper()}\n')
+        header_file.write('#endif\n')
+    family_types = ''.join(f' MODEL_VARIANT_TYPES_{family.upper()}' for family in families)
+    header_file.write(f'using ModelVariantType = std::variant<NullModel{family_types}>;\n')
     header_file.write('\n')
 
-    header_file.writelines(model_type_checkers)
-    
-    header_file.write('inline bool custom_model_creator (const nlohmann::json& model_json, ModelVariantType& model) {\n')
-    if_statement = 'if'
-    for type_checker, alias in zip(model_type_checkers, model_variant_types):
-        header_file.write(f'    {if_statement} (is_model_type_{alias} (model_json)) {{\n')
-        header_file.write(f'        model.emplace<{alias}>();\n')
-        header_file.write(f'        return true;\n')
-        header_file.write('    }\n')
-        if_statement = 'else if'
-    header_file.write(f'    model.emplace<NullModel>();\n')
-    header_file.write(f'    return false;\n')
+    # Model types are picked on the json shape alone, create gets the type and its name as ModelTypeTag<ModelType>
+    header_file.write('template <typename ModelType> struct ModelTypeTag { using type = ModelType; const char* name; };\n')
+    header_file.write('template <typename Create>\n')
+    header_file.write('inline decltype(auto) create_custom_model (const nlohmann::json& model_json, Create&& create) {\n')
+    for family in families:
+        if not model_variant_types[family]:
+            continue
+        header_file.write(f'#if {family_condition(family)}\n')
+        for alias in model_variant_types[family]:
+            header_file.write(f'    if (is_model_type_{alias} (model_json))\n')
+            header_file.write(f'        return create (ModelTypeTag<{alias}>{{ "{alias}" }});\n')
+        header_file.write('#endif\n')
+    header_file.write('    return create (ModelTypeTag<NullModel>{ nullptr });\n')
     header_file.write('}\n')
+    header_file.write('\n')
+
+    # Same on the name of a model type, for engines serialized in a cache image
+    header_file.write('template <typename Create>\n')
+    header_file.write('inline decltype(auto) create_custom_model_named (const std::string& name, Create&& create) {\n')
+    for family in families:
+        if not model_variant_types[family]:
+            continue
+        header_file.write(f'#if {family_condition(family)}\n')
+        for alias in model_variant_types[family]:
+            header_file.write(f'    if (name == "{alias}")\n')
+            header_file.write(f'        return create (ModelTypeTag<{alias}>{{ "{alias}" }});\n')
+        header_file.write('#endif\n')
+    header_file.write('    return create (ModelTypeTag<NullModel>{ nullptr });\n')
+    header_file.write('}\n')
+    header_file.write('\n')
+    header_file.write('} // namespace RTNeural\n')
+
+if args.families_file:
+    with open(args.families_file, 'w') as families_file:
+        for family in families:
+            if model_variant_types[family]:
+                families_file.write(f'{family}\n')